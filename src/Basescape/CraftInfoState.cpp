@@ -163,7 +163,7 @@ void CraftInfoState::init()
 
 	std::wostringstream firlsLine;
 	firlsLine << tr("STR_DAMAGE_UC_").arg(Text::formatPercentage(_craft->getDamagePercentage()));
-	if (_craft->getStatus() == "STR_REPAIRS" && _craft->getDamage() > 0)
+	if (_craft->getStatus() == Craft::STATUS_REPAIRS && _craft->getDamage() > 0)
 	{
 		int damageHours = (int)ceil((double)_craft->getDamage() / _craft->getRules()->getRepairRate());
 		firlsLine << formatTime(damageHours);
@@ -172,7 +172,7 @@ void CraftInfoState::init()
 
 	std::wostringstream secondLine;
 	secondLine << tr("STR_FUEL").arg(Text::formatPercentage(_craft->getFuelPercentage()));
-	if (_craft->getStatus() == "STR_REFUELLING" && _craft->getRules()->getMaxFuel() - _craft->getFuel() > 0)
+	if (_craft->getStatus() == Craft::STATUS_REFUELLING && _craft->getRules()->getMaxFuel() - _craft->getFuel() > 0)
 	{
 		int fuelHours = (int)ceil((double)(_craft->getRules()->getMaxFuel() - _craft->getFuel()) / _craft->getRules()->getRefuelRate() / 2.0);
 		secondLine << formatTime(fuelHours);
@@ -234,7 +234,7 @@ void CraftInfoState::init()
 			leftWeaponLine.str(L"");
 			leftWeaponLine << tr("STR_AMMO_").arg(w1->getAmmo()) << L"\n\x01";
 			leftWeaponLine << tr("STR_MAX").arg(w1->getRules()->getAmmoMax());
-			if (_craft->getStatus() == "STR_REARMING" && w1->getAmmo() < w1->getRules()->getAmmoMax())
+			if (_craft->getStatus() == Craft::STATUS_REARMING && w1->getAmmo() < w1->getRules()->getAmmoMax())
 			{
 				int rearmHours = (int)ceil((double)(w1->getRules()->getAmmoMax() - w1->getAmmo()) / w1->getRules()->getRearmRate());
 				leftWeaponLine << formatTime(rearmHours);
@@ -273,7 +273,7 @@ void CraftInfoState::init()
 			rightWeaponLine.str(L"");
 			rightWeaponLine << tr("STR_AMMO_").arg(w2->getAmmo()) << L"\n\x01";
 			rightWeaponLine << tr("STR_MAX").arg(w2->getRules()->getAmmoMax());
-			if (_craft->getStatus() == "STR_REARMING" && w2->getAmmo() < w2->getRules()->getAmmoMax())
+			if (_craft->getStatus() == Craft::STATUS_REARMING && w2->getAmmo() < w2->getRules()->getAmmoMax())
 			{
 				int rearmHours = (int)ceil((double)(w2->getRules()->getAmmoMax() - w2->getAmmo()) / w2->getRules()->getRearmRate());
 				rightWeaponLine << formatTime(rearmHours);
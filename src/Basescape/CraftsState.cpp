@@ -125,7 +125,7 @@ void CraftsState::init()
 		ss << (*i)->getNumWeapons() << "/" << (*i)->getRules()->getWeapons();
 		ss2 << (*i)->getNumSoldiers();
 		ss3 << (*i)->getNumVehicles();
-		_lstCrafts->addRow(5, (*i)->getName(_game->getLanguage()).c_str(), tr((*i)->getStatus()).c_str(), ss.str().c_str(), ss2.str().c_str(), ss3.str().c_str());
+		_lstCrafts->addRow(5, (*i)->getName(_game->getLanguage()).c_str(), tr((*i)->getStatusString()).c_str(), ss.str().c_str(), ss2.str().c_str(), ss3.str().c_str());
 	}
 }
 
@@ -150,7 +150,7 @@ void CraftsState::btnOkClick(Action *)
  */
 void CraftsState::lstCraftsClick(Action *)
 {
-	if (_base->getCrafts()->at(_lstCrafts->getSelectedRow())->getStatus() != "STR_OUT")
+	if (_base->getCrafts()->at(_lstCrafts->getSelectedRow())->getStatus() != Craft::STATUS_OUT)
 	{
 		_game->pushState(new CraftInfoState(_base, _lstCrafts->getSelectedRow()));
 	}
@@ -85,17 +85,17 @@ StoresState::StoresState(Base *base) : _base(base)
 	_lstStores->setBackground(_window);
 	_lstStores->setMargin(2);
 
-	const std::vector<std::string> &items = _game->getMod()->getItemsList();
-	for (std::vector<std::string>::const_iterator i = items.begin(); i != items.end(); ++i)
+	size_t items = _game->getMod()->getItemsList().size();
+	for (size_t i = 0; i != items; ++i)
 	{
-		int qty = _base->getStorageItems()->getItem(*i);
+		RuleItem *rule = _game->getMod()->getItemByIndex(i);
+		int qty = _base->getStorageItems()->getItem(rule);
 		if (qty > 0)
 		{
-			RuleItem *rule = _game->getMod()->getItem(*i, true);
 			std::wostringstream ss, ss2;
 			ss << qty;
 			ss2 << qty * rule->getSize();
-			_lstStores->addRow(3, tr(*i).c_str(), ss.str().c_str(), ss2.str().c_str());
+			_lstStores->addRow(3, tr(rule->getType()).c_str(), ss.str().c_str(), ss2.str().c_str());
 		}
 	}
 }
@@ -154,7 +154,7 @@ TransferItemsState::TransferItemsState(Base *baseFrom, Base *baseTo) : _baseFrom
 	}
 	for (std::vector<Craft*>::iterator i = _baseFrom->getCrafts()->begin(); i != _baseFrom->getCrafts()->end(); ++i)
 	{
-		if ((*i)->getStatus() != "STR_OUT" || (Options::canTransferCraftsWhileAirborne && (*i)->getFuel() >= (*i)->getFuelLimit(_baseTo)))
+		if ((*i)->getStatus() != Craft::STATUS_OUT || (Options::canTransferCraftsWhileAirborne && (*i)->getFuel() >= (*i)->getFuelLimit(_baseTo)))
 		{
 			TransferRow row = { TRANSFER_CRAFT, (*i), (*i)->getName(_game->getLanguage()), (int)(25 * _distance), 1, 0, 0 };
 			_items.push_back(row);
@@ -188,11 +188,11 @@ TransferItemsState::TransferItemsState(Base *baseFrom, Base *baseTo) : _baseFrom
 	const std::vector<std::string> &items = _game->getMod()->getItemsList();
 	for (std::vector<std::string>::const_iterator i = items.begin(); i != items.end(); ++i)
 	{
-		int qty = _baseFrom->getStorageItems()->getItem(*i);
+		RuleItem *rule = _game->getMod()->getItem(*i);
+		int qty = _baseFrom->getStorageItems()->getItem(rule);
 		if (qty > 0)
 		{
-			RuleItem *rule = _game->getMod()->getItem(*i);
-			TransferRow row = { TRANSFER_ITEM, rule, tr(*i), (int)(1 * _distance), qty, _baseTo->getStorageItems()->getItem(*i), 0 };
+			TransferRow row = { TRANSFER_ITEM, rule, tr(*i), (int)(1 * _distance), qty, _baseTo->getStorageItems()->getItem(rule), 0 };
 			_items.push_back(row);
 			std::string cat = getCategory(_items.size() - 1);
 			if (std::find(_cats.begin(), _cats.end(), cat) == _cats.end())
@@ -330,6 +330,8 @@ void TransferItemsState::completeTransfer()
 {
 	int time = (int)floor(6 + _distance / 10.0);
 	_game->getSavedGame()->setFunds(_game->getSavedGame()->getFunds() - _total);
+	// the items leave the stores all at once
+	ItemContainer sent(_game->getMod());
 	for (std::vector<TransferRow>::const_iterator i = _items.begin(); i != _items.end(); ++i)
 	{
 		if (i->amount > 0)
@@ -363,7 +365,7 @@ void TransferItemsState::completeTransfer()
 					if ((*s)->getCraft() == craft)
 					{
 						if ((*s)->isInPsiTraining()) (*s)->setPsiTraining();
-						if (craft->getStatus() == "STR_OUT") _baseTo->getSoldiers()->push_back(*s);
+						if (craft->getStatus() == Craft::STATUS_OUT) _baseTo->getSoldiers()->push_back(*s);
 						else
 						{
 							t = new Transfer(time);
@@ -383,7 +385,7 @@ void TransferItemsState::completeTransfer()
 				{
 					if (*c == craft)
 					{
-						if (craft->getStatus() == "STR_OUT")
+						if (craft->getStatus() == Craft::STATUS_OUT)
 						{
 							bool returning = (craft->getDestination() == (Target*)craft->getBase());
 							_baseTo->getCrafts()->push_back(craft);
@@ -433,7 +435,7 @@ void TransferItemsState::completeTransfer()
 				_baseTo->getTransfers()->push_back(t);
 				break;
 			case TRANSFER_ITEM:
-				_baseFrom->getStorageItems()->removeItem(((RuleItem*)i->rule)->getType(), i->amount);
+				sent.addItem((RuleItem*)i->rule, i->amount);
 				t = new Transfer(time);
 				t->setItems(((RuleItem*)i->rule)->getType(), i->amount);
 				_baseTo->getTransfers()->push_back(t);
@@ -441,6 +443,7 @@ void TransferItemsState::completeTransfer()
 			}
 		}
 	}
+	_baseFrom->getStorageItems()->subtract(sent);
 }
 
 /**
@@ -635,7 +638,7 @@ void TransferItemsState::increaseByValue(int change)
 			_pQty += craft->getNumSoldiers();
 			_iQty += craft->getItems()->getTotalSize(_game->getMod());
 			getRow().amount++;
-			if (!Options::canTransferCraftsWhileAirborne || craft->getStatus() != "STR_OUT")
+			if (!Options::canTransferCraftsWhileAirborne || craft->getStatus() != Craft::STATUS_OUT)
 				_total += getRow().cost;
 			break;
 		case TRANSFER_ITEM:
@@ -719,7 +722,7 @@ void TransferItemsState::decreaseByValue(int change)
 		break;
 	}
 	getRow().amount -= change;
-	if (!Options::canTransferCraftsWhileAirborne || 0 == craft || craft->getStatus() != "STR_OUT")
+	if (!Options::canTransferCraftsWhileAirborne || 0 == craft || craft->getStatus() != Craft::STATUS_OUT)
 		_total -= getRow().cost * change;
 	updateItemStrings();
 }
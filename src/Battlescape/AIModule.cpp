@@ -60,7 +60,8 @@ AIModule::AIModule(SavedBattleGame *save, BattleUnit *unit, Node *node) : _save(
 	_patrolAction = new BattleAction();
 	_psiAction = new BattleAction();
 	_targetFaction = FACTION_PLAYER;
-	if (_unit->getOriginalFaction() == FACTION_NEUTRAL)
+	// civilians, and our own units when the AI plays the battle for us
+	if (_unit->getOriginalFaction() == FACTION_NEUTRAL || (Options::battleAutoPlay && _unit->getFaction() == FACTION_PLAYER))
 	{
 		_targetFaction = FACTION_HOSTILE;
 	}
@@ -408,6 +409,38 @@ bool AIModule::getWasHitBy(int attacker) const
 {
 	return std::find(_wasHitBy.begin(), _wasHitBy.end(), attacker) != _wasHitBy.end();
 }
+
+/**
+ * Runs the reachable tile searches think() opens with ahead of time,
+ * using the same TU budgets, so they are ready (or discarded if the
+ * battle changed) by the time this unit gets to act.
+ */
+void AIModule::prefetchReachable()
+{
+	std::vector<int> budgets;
+	budgets.push_back(_unit->getTimeUnits());
+	BattleItem *weapon = _unit->getMainHandWeapon(false);
+	if (weapon && _save->isItemUsable(weapon->getRules()))
+	{
+		RuleItem *rule = weapon->getRules();
+		if (rule->getBattleType() == BT_FIREARM)
+		{
+			if (rule->getWaypoints() != 0 || (weapon->getAmmoItem() && weapon->getAmmoItem()->getRules()->getWaypoints() != 0))
+			{
+				budgets.push_back(_unit->getTimeUnits() - _unit->getActionTUs(BA_AIMEDSHOT, weapon));
+			}
+			else
+			{
+				budgets.push_back(_unit->getTimeUnits() - _unit->getActionTUs(BA_SNAPSHOT, weapon));
+			}
+		}
+		else if (rule->getBattleType() == BT_MELEE)
+		{
+			budgets.push_back(_unit->getTimeUnits() - _unit->getActionTUs(BA_HIT, weapon));
+		}
+	}
+	_save->getPathfinding()->prefetchReachable(_unit, budgets);
+}
 /*
  * Sets up a patrol action.
  * this is mainly going from node to node, moving about the map.
@@ -463,6 +496,7 @@ void AIModule::setupPatrol()
 		}
 	}
 	int triesLeft = 5;
+	std::vector<Node*> failedNodes;
 
 	while (_toNode == 0 && triesLeft)
 	{
@@ -551,11 +585,18 @@ void AIModule::setupPatrol()
 			_save->getPathfinding()->calculate(_unit, _toNode->getPosition());
 			if (_save->getPathfinding()->getStartDirection() == -1)
 			{
+				// hold on to it for now so the next try picks a different node
+				_toNode->allocateNode();
+				failedNodes.push_back(_toNode);
 				_toNode = 0;
 			}
 			_save->getPathfinding()->abortPath();
 		}
 	}
+	for (std::vector<Node*>::iterator i = failedNodes.begin(); i != failedNodes.end(); ++i)
+	{
+		(*i)->freeNode();
+	}
 
 	if (_toNode != 0)
 	{
@@ -1014,7 +1055,7 @@ int AIModule::getSpottingUnits(const Position& pos) const
 			Position targetVoxel;
 			if (checking)
 			{
-				if (_save->getTileEngine()->canTargetUnit(&originVoxel, _save->getTile(pos), &targetVoxel, *i, _unit))
+				if (_save->getTileEngine()->canTargetUnitCached(&originVoxel, _save->getTile(pos), *i, _unit))
 				{
 					tally++;
 				}
@@ -64,6 +64,8 @@ public:
 	YAML::Node save() const;
 	/// Runs Module functionality every AI cycle.
 	void think(BattleAction *action);
+	/// Runs the reachable tile searches think() will need ahead of time.
+	void prefetchReachable();
 	/// Sets the "unit was hit" flag true.
 	void setWasHitBy(BattleUnit *attacker);
 	/// Gets whether the unit was hit.
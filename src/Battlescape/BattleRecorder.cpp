@@ -0,0 +1,248 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BattleRecorder.h"
+#include <sstream>
+#include <time.h>
+#include "BattlescapeGame.h"
+#include "../Engine/Options.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Exception.h"
+#include "../Engine/RNG.h"
+#include "../Savegame/SavedGame.h"
+#include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/BattleUnit.h"
+#include "../Savegame/BattleItem.h"
+#include "../Savegame/Tile.h"
+#include "../Mod/MapData.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/**
+ * Mixes a value into an FNV-1a hash.
+ * @param hash Hash so far.
+ * @param value Value to add.
+ */
+void mix(unsigned int &hash, int value)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 16777619u;
+	}
+}
+
+}
+
+/**
+ * Creates a recorder that doesn't record anything until told to.
+ */
+BattleRecorder::BattleRecorder() : _mode(REC_OFF), _next(0), _diverged(false)
+{
+}
+
+/**
+ * Closes the log and reports how the verification went.
+ */
+BattleRecorder::~BattleRecorder()
+{
+	if (_mode == REC_VERIFYING && !_diverged)
+	{
+		Log(LOG_INFO) << "Battle matched " << _next << " of " << _expected.size() << " recorded entries";
+	}
+	if (_log.is_open())
+	{
+		_log.close();
+	}
+}
+
+/**
+ * Saves the game as it is at the start of the battle, along with
+ * the RNG seed, and opens the log the battle will be recorded to.
+ * Load the save and set battleVerify to the log to check a run against it.
+ * @param game Pointer to the saved game, with the battle in it.
+ */
+void BattleRecorder::record(SavedGame *game)
+{
+	std::ostringstream ss;
+	ss << "battle_" << time(0);
+	_name = ss.str();
+	try
+	{
+		game->save(_name + ".sav");
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_ERROR) << e.what();
+		return;
+	}
+	std::string log = Options::getMasterUserFolder() + _name + ".log";
+	_log.open(log.c_str());
+	if (!_log)
+	{
+		Log(LOG_WARNING) << "Failed to create " << log;
+		return;
+	}
+	_mode = REC_RECORDING;
+	_log << "seed " << RNG::getSeed() << std::endl;
+	ss.str("");
+	ss << "start " << hashState(game->getSavedBattle());
+	entry(ss.str());
+	Log(LOG_INFO) << "Recording battle to " << _name;
+}
+
+/**
+ * Reads back a log made by record() and restores its RNG seed, so the
+ * battle (loaded from the matching save) can be checked entry by entry,
+ * starting with the state it starts in.
+ * @param filename Log filename, relative to the user folder.
+ * @param save Pointer to the battle, as loaded from the recorded save.
+ */
+void BattleRecorder::verify(const std::string &filename, SavedBattleGame *save)
+{
+	std::string log = Options::getMasterUserFolder() + filename;
+	std::ifstream in(log.c_str());
+	if (!in)
+	{
+		Log(LOG_WARNING) << "Failed to open battle log " << log;
+		return;
+	}
+	std::string line;
+	uint64_t seed = 0;
+	if (!(in >> line >> seed) || line != "seed")
+	{
+		Log(LOG_WARNING) << "Not a battle log: " << log;
+		return;
+	}
+	std::getline(in, line);
+	while (std::getline(in, line))
+	{
+		if (!line.empty())
+		{
+			_expected.push_back(line);
+		}
+	}
+	_mode = REC_VERIFYING;
+	_name = filename;
+	RNG::setSeed(seed);
+	Log(LOG_INFO) << "Verifying against " << filename << ", " << _expected.size() << " entries";
+
+	// a different save than the one recorded shows up right here
+	std::ostringstream ss;
+	ss << "start " << hashState(save);
+	entry(ss.str());
+}
+
+/**
+ * Writes a line to the log, or compares it to the next recorded one
+ * when verifying. Only the first difference is reported, since
+ * everything after it is bound to differ too.
+ * @param line Log entry.
+ */
+void BattleRecorder::entry(const std::string &line)
+{
+	if (_mode == REC_RECORDING)
+	{
+		_log << line << std::endl;
+	}
+	else if (_mode == REC_VERIFYING && !_diverged)
+	{
+		if (_next >= _expected.size())
+		{
+			Log(LOG_ERROR) << "Battle went past the end of " << _name << ": " << line;
+			_diverged = true;
+		}
+		else if (_expected[_next] != line)
+		{
+			Log(LOG_ERROR) << "Battle diverged from " << _name << " at entry " << _next << ": expected \"" << _expected[_next] << "\", got \"" << line << "\"";
+			_diverged = true;
+		}
+		else
+		{
+			++_next;
+		}
+	}
+}
+
+/**
+ * Records an action issued by either side.
+ * @param save Pointer to the battle.
+ * @param action The action.
+ */
+void BattleRecorder::action(SavedBattleGame *save, const BattleAction &action)
+{
+	if (_mode == REC_OFF || !action.actor)
+		return;
+	std::ostringstream ss;
+	ss << "action " << save->getTurn() << " " << save->getSide() << " " << action.actor->getId() << " " << action.type << " "
+		<< action.target.x << " " << action.target.y << " " << action.target.z << " " << (action.weapon ? action.weapon->getId() : -1);
+	entry(ss.str());
+}
+
+/**
+ * Records the state the battle is in at the end of a side's turn.
+ * @param save Pointer to the battle.
+ */
+void BattleRecorder::endTurn(SavedBattleGame *save)
+{
+	if (_mode == REC_OFF)
+		return;
+	std::ostringstream ss;
+	ss << "turn " << save->getTurn() << " " << save->getSide() << " " << hashState(save);
+	entry(ss.str());
+}
+
+/**
+ * Hashes everything a diverging run would show up in sooner or
+ * later: the units, the terrain and the RNG state.
+ * @param save Pointer to the battle.
+ * @return State hash.
+ */
+unsigned int BattleRecorder::hashState(SavedBattleGame *save)
+{
+	unsigned int hash = 2166136261u;
+	mix(hash, (int)RNG::getSeed());
+	mix(hash, (int)(RNG::getSeed() >> 32));
+	for (std::vector<BattleUnit*>::iterator i = save->getUnits()->begin(); i != save->getUnits()->end(); ++i)
+	{
+		BattleUnit *unit = *i;
+		mix(hash, unit->getId());
+		mix(hash, unit->getPosition().x | (unit->getPosition().y << 8) | (unit->getPosition().z << 16));
+		mix(hash, unit->getDirection() | (unit->getStatus() << 8) | (unit->getFaction() << 16));
+		mix(hash, unit->getTimeUnits() | (unit->getEnergy() << 16));
+		mix(hash, unit->getHealth() | (unit->getStunlevel() << 16));
+	}
+	for (int i = 0; i < save->getMapSizeXYZ(); ++i)
+	{
+		Tile *tile = save->getTiles()[i];
+		for (int part = O_FLOOR; part <= O_OBJECT; ++part)
+		{
+			int id, set;
+			tile->getMapData(&id, &set, part);
+			mix(hash, id | (set << 16));
+		}
+		mix(hash, tile->getFire() | (tile->getSmoke() << 8) | ((int)tile->getInventory()->size() << 16));
+	}
+	return hash;
+}
+
+}
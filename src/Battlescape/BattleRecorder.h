@@ -0,0 +1,69 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <fstream>
+#include <vector>
+
+namespace OpenXcom
+{
+
+class SavedGame;
+class SavedBattleGame;
+struct BattleAction;
+
+/**
+ * Records a battle as its start state, RNG seed and the actions issued,
+ * with a hash of the state at the end of every turn, so a later run of
+ * the same battle can be checked for the same outcome. The actions are
+ * only compared, not issued again, so only battles the AI plays on its
+ * own (battleAutoPlay) come out the same without someone at the controls.
+ */
+class BattleRecorder
+{
+private:
+	enum Mode { REC_OFF, REC_RECORDING, REC_VERIFYING };
+	Mode _mode;
+	std::ofstream _log;
+	std::string _name;
+	std::vector<std::string> _expected;
+	size_t _next;
+	bool _diverged;
+	/// Writes or checks a line of the log.
+	void entry(const std::string &line);
+public:
+	/// Creates a recorder that does nothing.
+	BattleRecorder();
+	/// Cleans up the recorder.
+	~BattleRecorder();
+	/// Saves the battle's start state and starts a new log.
+	void record(SavedGame *game);
+	/// Gets whether the battle is being recorded or verified.
+	bool isActive() const { return _mode != REC_OFF; }
+	/// Loads a log to check the current battle against.
+	void verify(const std::string &filename, SavedBattleGame *save);
+	/// Records an action.
+	void action(SavedBattleGame *save, const BattleAction &action);
+	/// Records the end of a turn.
+	void endTurn(SavedBattleGame *save);
+	/// Gets a hash of the battle state.
+	static unsigned int hashState(SavedBattleGame *save);
+};
+
+}
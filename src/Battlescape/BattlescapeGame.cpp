@@ -17,6 +17,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <sstream>
+#include <algorithm>
 #include "BattlescapeGame.h"
 #include "BattlescapeState.h"
 #include "Map.h"
@@ -55,6 +56,8 @@
 #include "InfoboxOKState.h"
 #include "UnitFallBState.h"
 #include "../Engine/Logger.h"
+#include "../Engine/Profiler.h"
+#include "BattleRecorder.h"
 #include "../Savegame/BattleUnitStatistics.h"
 #include "../fmath.h"
 
@@ -68,7 +71,8 @@ bool BattlescapeGame::_debugPlay = false;
  * @param save Pointer to the save game.
  * @param parentState Pointer to the parent battlescape state.
  */
-BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parentState) : _save(save), _parentState(parentState), _playerPanicHandled(true), _AIActionCounter(0), _AISecondMove(false), _playedAggroSound(false), _endTurnRequested(false), _endTurnProcessed(false)
+BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parentState) : _save(save), _parentState(parentState), _playerPanicHandled(true), _AIActionCounter(0), _AISecondMove(false), _playedAggroSound(false), _endTurnRequested(false), _endTurnProcessed(false),
+	_battleStart(SDL_GetTicks()), _sideTurns(0), _recorder(0), _prefetchAfter(0)
 {
 	
 	_currentAction.actor = 0;
@@ -76,6 +80,19 @@ BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parent
 	_currentAction.type = BA_NONE;
 
 	_debugPlay = false;
+	Profiler::startBattle();
+
+	_recorder = new BattleRecorder();
+	if (!Options::battleVerify.empty())
+	{
+		_recorder->verify(Options::battleVerify, _save);
+		// only the battle loaded right after setting it is checked
+		Options::battleVerify.clear();
+	}
+	else if (Options::battleRecord)
+	{
+		_recorder->record(parentState->getGame()->getSavedGame());
+	}
 
 	checkForCasualties(0, 0, true);
 	cancelCurrentAction();
@@ -92,6 +109,8 @@ BattlescapeGame::~BattlescapeGame()
 		delete *i;
 	}
 	cleanupDeleted();
+	Profiler::endBattle();
+	delete _recorder;
 }
 
 /**
@@ -102,13 +121,14 @@ void BattlescapeGame::think()
 	// nothing is happening - see if we need some alien AI or units panicking or what have you
 	if (_states.empty())
 	{
-		// it's a non player side (ALIENS or CIVILIANS)
-		if (_save->getSide() != FACTION_PLAYER)
+		// it's a non player side (ALIENS or CIVILIANS), or the AI is playing for us too
+		if (_save->getSide() != FACTION_PLAYER || Options::battleAutoPlay)
 		{
 			if (!_debugPlay)
 			{
 				if (_save->getSelectedUnit())
 				{
+					Profiler::Scope profile(Profiler::PROF_AI);
 					if (!handlePanickingUnit(_save->getSelectedUnit()))
 						handleAI(_save->getSelectedUnit());
 				}
@@ -290,6 +310,12 @@ void BattlescapeGame::handleAI(BattleUnit *unit)
 		}
 	}
 
+	if (!_states.empty())
+	{
+		// done after the next state update, so it lands in a frame spent animating
+		_prefetchAfter = unit;
+	}
+
 	if (action.type == BA_NONE)
 	{
 		_parentState->debug(L"Idle");
@@ -319,6 +345,44 @@ void BattlescapeGame::handleAI(BattleUnit *unit)
 	}
 }
 
+/**
+ * Guesses which unit the AI moves after this one and runs its
+ * reachable tile searches now, while the action that was just queued
+ * is animating, instead of when that unit thinks. A wrong guess
+ * or a change to the battle only costs the wasted search.
+ * @param unit The unit about to act.
+ */
+void BattlescapeGame::prefetchAI(BattleUnit *unit)
+{
+	std::vector<BattleUnit*> *units = _save->getUnits();
+	std::vector<BattleUnit*>::iterator current = std::find(units->begin(), units->end(), unit);
+	if (current == units->end())
+	{
+		return;
+	}
+	std::vector<BattleUnit*>::iterator i = current;
+	while (true)
+	{
+		++i;
+		if (i == units->end())
+		{
+			i = units->begin();
+		}
+		if (i == current)
+		{
+			return;
+		}
+		if ((*i)->isSelectable(_save->getSide(), true, false))
+		{
+			if ((*i)->getAIModule())
+			{
+				(*i)->getAIModule()->prefetchReachable();
+			}
+			return;
+		}
+	}
+}
+
 /**
  * Toggles the Kneel/Standup status of the unit.
  * @param bu Pointer to a unit.
@@ -352,6 +416,8 @@ bool BattlescapeGame::kneel(BattleUnit *bu)
  */
 void BattlescapeGame::endTurn()
 {
+	logTurnTimes();
+	Profiler::Scope profile(Profiler::PROF_END_TURN);
 
 	Position p;
 
@@ -362,6 +428,8 @@ void BattlescapeGame::endTurn()
 	_parentState->showLaunchButton(false);
 	_currentAction.targeting = false;
 	_AISecondMove = false;
+	_prefetchAfter = 0;
+	_save->getTileEngine()->clearSpotCache();
 
 	if (!_endTurnProcessed)
 	{
@@ -916,8 +984,14 @@ void BattlescapeGame::handleState()
 		}
 		else
 		{
+			Profiler::Scope profile(Profiler::PROF_STATES);
 			_states.front()->think();
 		}
+		if (_prefetchAfter)
+		{
+			prefetchAI(_prefetchAfter);
+			_prefetchAfter = 0;
+		}
 		getMap()->invalidate(); // redraw map
 	}
 }
@@ -928,6 +1002,10 @@ void BattlescapeGame::handleState()
  */
 void BattlescapeGame::statePushFront(BattleState *bs)
 {
+	if (_recorder->isActive())
+	{
+		_recorder->action(_save, bs->getAction());
+	}
 	_states.push_front(bs);
 	bs->init();
 }
@@ -938,6 +1016,10 @@ void BattlescapeGame::statePushFront(BattleState *bs)
  */
 void BattlescapeGame::statePushNext(BattleState *bs)
 {
+	if (_recorder->isActive())
+	{
+		_recorder->action(_save, bs->getAction());
+	}
 	if (_states.empty())
 	{
 		_states.push_front(bs);
@@ -956,6 +1038,10 @@ void BattlescapeGame::statePushNext(BattleState *bs)
  */
 void BattlescapeGame::statePushBack(BattleState *bs)
 {
+	if (bs && _recorder->isActive())
+	{
+		_recorder->action(_save, bs->getAction());
+	}
 	if (_states.empty())
 	{
 		_states.push_front(bs);
@@ -1008,7 +1094,8 @@ void BattlescapeGame::popState()
 	// handle the end of this unit's actions
 	if (action.actor && noActionsPending(action.actor))
 	{
-		if (action.actor->getFaction() == FACTION_PLAYER)
+		bool autoPlayer = Options::battleAutoPlay && action.actor->getFaction() == FACTION_PLAYER && _save->getSide() == FACTION_PLAYER;
+		if (action.actor->getFaction() == FACTION_PLAYER && !autoPlayer)
 		{
 			// spend TUs of "target triggered actions" (shooting, throwing) only
 			// the other actions' TUs (healing,scanning,..) are already take care of
@@ -1037,7 +1124,7 @@ void BattlescapeGame::popState()
 		{
 			// spend TUs
 			action.actor->spendTimeUnits(action.TU);
-			if (_save->getSide() != FACTION_PLAYER && !_debugPlay)
+			if ((_save->getSide() != FACTION_PLAYER || autoPlayer) && !_debugPlay)
 			{
 				// AI does three things per unit, before switching to the next, or it got killed before doing the second thing
 				if (_AIActionCounter > 2 || _save->getSelectedUnit() == 0 || _save->getSelectedUnit()->isOut())
@@ -1384,6 +1471,17 @@ BattleAction *BattlescapeGame::getCurrentAction()
 	return &_currentAction;
 }
 
+/**
+ * Determines whether a state is at the front of the queue,
+ * ie. it hasn't finished and nothing was pushed in front of it.
+ * @param state Pointer to the state.
+ * @return True if it's the state currently running.
+ */
+bool BattlescapeGame::isCurrentState(const BattleState *state) const
+{
+	return !_states.empty() && _states.front() == state;
+}
+
 /**
  * Determines whether an action is currently going on?
  * @return true or false.
@@ -2261,7 +2359,7 @@ std::list<BattleState*> BattlescapeGame::getStates()
  */
 void BattlescapeGame::autoEndBattle()
 {
-	if (Options::battleAutoEnd)
+	if (Options::battleAutoEnd || Options::battleAutoPlay)
 	{
 		bool end = false;
 		if (_save->getObjectiveType() == MUST_DESTROY)
@@ -2284,4 +2382,23 @@ void BattlescapeGame::autoEndBattle()
 	}
 }
 
+/**
+ * Logs where the time went during the side's turn that just
+ * ended when the AI is playing the whole battle, for soak tests
+ * and profiling, then starts counting again.
+ */
+void BattlescapeGame::logTurnTimes()
+{
+	++_sideTurns;
+	if (Options::battleAutoPlay)
+	{
+		Uint32 elapsed = std::max((Uint32)1, SDL_GetTicks() - _battleStart);
+		Log(LOG_INFO) << "Turn " << _save->getTurn() << " side " << _save->getSide() << ": "
+			<< Profiler::getTurnTime(Profiler::PROF_AI) << " ms AI, " << Profiler::getTurnTime(Profiler::PROF_STATES) << " ms actions, "
+			<< Profiler::getTurnTime(Profiler::PROF_END_TURN) << " ms changing turns, " << (_sideTurns * 1000.0 / elapsed) << " turns/s";
+	}
+	Profiler::endTurn(_save->getTurn(), _save->getSide());
+	_recorder->endTurn(_save);
+}
+
 }
@@ -37,6 +37,7 @@ class Pathfinding;
 class Mod;
 class InfoboxOKState;
 class SoldierDiary;
+class BattleRecorder;
 
 enum BattleActionType { BA_NONE, BA_TURN, BA_WALK, BA_PRIME, BA_THROW, BA_AUTOSHOT, BA_SNAPSHOT, BA_AIMEDSHOT, BA_HIT, BA_USE, BA_LAUNCH, BA_MINDCONTROL, BA_PANIC, BA_RETHINK };
 
@@ -76,6 +77,13 @@ private:
 	BattleAction _currentAction;
 	bool _AISecondMove, _playedAggroSound;
 	bool _endTurnRequested, _endTurnProcessed;
+	Uint32 _battleStart;
+	int _sideTurns;
+	BattleRecorder *_recorder;
+	BattleUnit *_prefetchAfter;
+
+	/// Logs where the time went during the last side's turn.
+	void logTurnTimes();
 
 	/// Ends the turn.
 	void endTurn();
@@ -85,6 +93,8 @@ private:
 	bool handlePanickingUnit(BattleUnit *unit);
 	/// Determines whether there are any actions pending for the given unit.
 	bool noActionsPending(BattleUnit *bu);
+	/// Starts planning the next AI unit while this one acts.
+	void prefetchAI(BattleUnit *unit);
 	std::vector<InfoboxOKState*> _infoboxQueue;
 	/// Shows the infoboxes in the queue (if any).
 	void showInfoBoxQueue();
@@ -134,6 +144,8 @@ public:
 	BattleAction *getCurrentAction();
 	/// Determines whether there is an action currently going on.
 	bool isBusy() const;
+	/// Determines whether a state is the one currently running.
+	bool isCurrentState(const BattleState *state) const;
 	/// Activates primary action (left click).
 	void primaryAction(Position pos);
 	/// Activates secondary action (right click).
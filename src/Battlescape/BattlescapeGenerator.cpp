@@ -19,6 +19,9 @@
 #include <assert.h>
 #include <fstream>
 #include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <SDL_thread.h>
 #include "BattlescapeGenerator.h"
 #include "TileEngine.h"
 #include "Inventory.h"
@@ -46,6 +49,7 @@
 #include "../Engine/RNG.h"
 #include "../Engine/Exception.h"
 #include "../Engine/Logger.h"
+#include "../Engine/CrossPlatform.h"
 #include "../Mod/MapBlock.h"
 #include "../Mod/MapDataSet.h"
 #include "../Mod/RuleUfo.h"
@@ -71,7 +75,7 @@ static bool _addItem(BattleItem *item, BattleUnit *unit, Mod *mod, SavedBattleGa
  * @param game pointer to Game object.
  */
 BattlescapeGenerator::BattlescapeGenerator(Game *game) : _game(game), _save(game->getSavedGame()->getSavedBattle()), _mod(game->getMod()), _craft(0), _ufo(0), _base(0), _mission(0), _alienBase(0), _terrain(0), _mapsize_x(0), _mapsize_y(0), _mapsize_z(0),
-														 _worldTexture(0), _worldShade(0), _unitSequence(0), _craftInventoryTile(0), _alienItemLevel(0), _baseInventory(false), _generateFuel(true), _craftDeployed(false), _craftZ(0), _blocksToDo(0), _dummy(0)
+														 _worldTexture(0), _worldShade(0), _unitSequence(0), _craftInventoryTile(0), _alienItemLevel(0), _baseInventory(false), _generateFuel(true), _craftDeployed(false), _craftZ(0), _blocksToDo(0), _dummy(0), _deferFills(false)
 {
 	_allowAutoLoadout = !Options::disableAutoEquip;
 }
@@ -497,6 +501,7 @@ void BattlescapeGenerator::nextStage()
  */
 void BattlescapeGenerator::run()
 {
+	Uint32 setupStart = SDL_GetTicks();
 	AlienDeployment *ruleDeploy = _game->getMod()->getDeployment(_ufo?_ufo->getRules()->getType():_save->getMissionType(), true);
 
 	_save->setTurnLimit(ruleDeploy->getTurnLimit());
@@ -602,6 +607,8 @@ void BattlescapeGenerator::run()
 	_save->getTileEngine()->calculateTerrainLighting();
 	_save->getTileEngine()->calculateUnitLighting();
 	_save->getTileEngine()->recalculateFOV();
+
+	Log(LOG_INFO) << "Battle set up in " << (SDL_GetTicks() - setupStart) << " ms, peak memory use " << CrossPlatform::getPeakMemoryUsage() << " KB";
 }
 
 /**
@@ -660,7 +667,7 @@ void BattlescapeGenerator::deployXCOM()
 	for (std::vector<Soldier*>::iterator i = _base->getSoldiers()->begin(); i != _base->getSoldiers()->end(); ++i)
 	{
 		if ((_craft != 0 && (*i)->getCraft() == _craft) ||
-			(_craft == 0 && (*i)->getWoundRecovery() == 0 && ((*i)->getCraft() == 0 || (*i)->getCraft()->getStatus() != "STR_OUT")))
+			(_craft == 0 && (*i)->getWoundRecovery() == 0 && ((*i)->getCraft() == 0 || (*i)->getCraft()->getStatus() != Craft::STATUS_OUT)))
 		{
 			BattleUnit *unit = addXCOMUnit(new BattleUnit(*i, _save->getDepth()));
 			if (unit && !_save->getSelectedUnit())
@@ -687,7 +694,8 @@ void BattlescapeGenerator::deployXCOM()
 	if (_craft != 0)
 	{
 		// add items that are in the craft
-		for (std::map<std::string, int>::iterator i = _craft->getItems()->getContents()->begin(); i != _craft->getItems()->getContents()->end(); ++i)
+		std::map<std::string, int> contents = _craft->getItems()->getContents();
+		for (std::map<std::string, int>::iterator i = contents.begin(); i != contents.end(); ++i)
 		{
 			for (int count = 0; count < i->second; count++)
 			{
@@ -701,7 +709,8 @@ void BattlescapeGenerator::deployXCOM()
 		if (_game->getSavedGame()->getMonthsPassed() != -1)
 		{
 			// add items that are in the base
-			for (std::map<std::string, int>::iterator i = _base->getStorageItems()->getContents()->begin(); i != _base->getStorageItems()->getContents()->end();)
+			std::map<std::string, int> contents = _base->getStorageItems()->getContents();
+			for (std::map<std::string, int>::iterator i = contents.begin(); i != contents.end(); ++i)
 			{
 				// only put items in the battlescape that make sense (when the item got a sprite, it's probably ok)
 				RuleItem *rule = _game->getMod()->getItem(i->first, true);
@@ -709,24 +718,19 @@ void BattlescapeGenerator::deployXCOM()
 				{
 					for (int count = 0; count < i->second; count++)
 					{
-						_craftInventoryTile->addItem(new BattleItem(_game->getMod()->getItem(i->first, true), _save->getCurrentItemId()), ground);
+						_craftInventoryTile->addItem(new BattleItem(rule, _save->getCurrentItemId()), ground);
 					}
-					std::map<std::string, int>::iterator tmp = i;
-					++i;
-					_base->getStorageItems()->removeItem(tmp->first, tmp->second);
-				}
-				else
-				{
-					++i;
+					_base->getStorageItems()->removeItem(rule, i->second);
 				}
 			}
 		}
 		// add items from crafts in base
 		for (std::vector<Craft*>::iterator c = _base->getCrafts()->begin(); c != _base->getCrafts()->end(); ++c)
 		{
-			if ((*c)->getStatus() == "STR_OUT")
+			if ((*c)->getStatus() == Craft::STATUS_OUT)
 				continue;
-			for (std::map<std::string, int>::iterator i = (*c)->getItems()->getContents()->begin(); i != (*c)->getItems()->getContents()->end(); ++i)
+			std::map<std::string, int> contents = (*c)->getItems()->getContents();
+			for (std::map<std::string, int>::iterator i = contents.begin(); i != contents.end(); ++i)
 			{
 				for (int count = 0; count < i->second; count++)
 				{
@@ -1528,24 +1532,28 @@ bool BattlescapeGenerator::addItem(BattleItem *item, BattleUnit *unit, bool allo
 int BattlescapeGenerator::loadMAP(MapBlock *mapblock, int xoff, int yoff, RuleTerrain *terrain, int mapDataSetOffset, bool discovered, bool craft)
 {
 	int sizex, sizey, sizez;
-	int x = xoff, y = yoff, z = 0;
-	char size[3];
-	unsigned char value[4];
+	int z = 0;
 	std::ostringstream filename;
 	filename << "MAPS/" << mapblock->getName() << ".MAP";
-	unsigned int terrainObjectID;
 
 	// Load file
-	std::ifstream mapFile (FileMap::getFilePath(filename.str()).c_str(), std::ios::in| std::ios::binary);
+	const std::vector<Uint8> *mapFile = FileMap::getFileContents(filename.str());
 	if (!mapFile)
 	{
 		throw Exception(filename.str() + " not found");
 	}
+	if (mapFile->size() < 3)
+	{
+		throw Exception("Invalid MAP file: " + filename.str());
+	}
+	if ((mapFile->size() - 3) % 4 != 0)
+	{
+		Log(LOG_WARNING) << filename.str() << " has " << (mapFile->size() - 3) % 4 << " bytes past its last tile, ignoring them";
+	}
 
-	mapFile.read((char*)&size, sizeof(size));
-	sizey = (int)size[0];
-	sizex = (int)size[1];
-	sizez = (int)size[2];
+	sizey = (int)(char)(*mapFile)[0];
+	sizex = (int)(char)(*mapFile)[1];
+	sizez = (int)(char)(*mapFile)[2];
 
 	mapblock->setSizeZ(sizez);
 
@@ -1568,7 +1576,7 @@ int BattlescapeGenerator::loadMAP(MapBlock *mapblock, int xoff, int yoff, RuleTe
 	for (int i = _mapsize_z-1; i >0; i--)
 	{
 		// check if there is already a layer - if so, we have to move Z up
-		MapData *floor = _save->getTile(Position(x, y, i))->getMapData(O_FLOOR);
+		MapData *floor = _save->getTile(Position(xoff, yoff, i))->getMapData(O_FLOOR);
 		if (floor != 0)
 		{
 			z += i;
@@ -1585,63 +1593,162 @@ int BattlescapeGenerator::loadMAP(MapBlock *mapblock, int xoff, int yoff, RuleTe
 		throw Exception("Something is wrong in your map definitions, craft/ufo map is too tall?");
 	}
 
-	while (mapFile.read((char*)&value, sizeof(value)))
+	BlockFill fill;
+	fill.mapblock = mapblock;
+	fill.data = mapFile;
+	fill.terrain = terrain;
+	fill.xoff = xoff;
+	fill.yoff = yoff;
+	fill.z = z;
+	fill.mapDataSetOffset = mapDataSetOffset;
+	fill.discovered = discovered;
+	if (_deferFills)
+	{
+		_pendingFills.push_back(fill);
+	}
+	else
+	{
+		fillBlock(fill);
+		Tile::touchTerrain();
+	}
+
+	if (_generateFuel)
+	{
+		// if one of the mapBlocks has an items array defined, don't deploy fuel algorithmically
+		_generateFuel = mapblock->getItems()->empty();
+	}
+	for (std::map<std::string, std::vector<Position> >::const_iterator i = mapblock->getItems()->begin(); i != mapblock->getItems()->end(); ++i)
 	{
+		RuleItem *rule = _game->getMod()->getItem((*i).first, true);
+		for (std::vector<Position>::const_iterator j = (*i).second.begin(); j != (*i).second.end(); ++j)
+		{
+			BattleItem *item = new BattleItem(rule, _save->getCurrentItemId());
+			_save->getItems()->push_back(item);
+			_save->getTile((*j) + Position(xoff, yoff, 0))->addItem(item, _game->getMod()->getInventory("STR_GROUND", true));
+		}
+	}
+	return sizez;
+}
+
+/**
+ * Fills in the tiles of a MAP block that loadMAP() has checked.
+ * Only touches the block's own tiles, so blocks that don't overlap
+ * can be filled in at the same time. Doesn't touch the tile
+ * revisions either, that's up to the caller.
+ * @param fill The block to fill in.
+ */
+void BattlescapeGenerator::fillBlock(const BlockFill &fill)
+{
+	const std::vector<Uint8> &data = *fill.data;
+	int sizex = fill.mapblock->getSizeX();
+	int sizey = fill.mapblock->getSizeY();
+	int x = fill.xoff, y = fill.yoff, z = fill.z;
+	// stop at the bottom of the map even if the file has more layers in it
+	for (size_t offset = 3; offset + 4 <= data.size() && z >= 0; offset += 4)
+	{
+		Tile *tile = _save->getTile(Position(x, y, z));
 		for (int part = 0; part < 4; ++part)
 		{
-			terrainObjectID = ((unsigned char)value[part]);
+			unsigned int terrainObjectID = data[offset + part];
 			if (terrainObjectID>0)
 			{
-				int mapDataSetID = mapDataSetOffset;
+				int mapDataSetID = fill.mapDataSetOffset;
 				unsigned int mapDataID = terrainObjectID;
-				MapData *md = terrain->getMapData(&mapDataID, &mapDataSetID);
-				if (mapDataSetOffset > 0) // ie: ufo or craft.
+				MapData *md = fill.terrain->getMapData(&mapDataID, &mapDataSetID);
+				if (fill.mapDataSetOffset > 0) // ie: ufo or craft.
 				{
-					_save->getTile(Position(x, y, z))->setMapData(0, -1, -1, 3);
+					tile->setMapDataUntracked(0, -1, -1, 3);
 				}
-				_save->getTile(Position(x, y, z))->setMapData(md, mapDataID, mapDataSetID, part);
+				tile->setMapDataUntracked(md, mapDataID, mapDataSetID, part);
 			}
 		}
 
-		_save->getTile(Position(x, y, z))->setDiscovered((discovered || mapblock->isFloorRevealed(z)), 2);
+		tile->setDiscovered((fill.discovered || fill.mapblock->isFloorRevealed(z)), 2);
 
 		x++;
 
-		if (x == (sizex + xoff))
+		if (x == (sizex + fill.xoff))
 		{
-			x = xoff;
+			x = fill.xoff;
 			y++;
 		}
-		if (y == (sizey + yoff))
+		if (y == (sizey + fill.yoff))
 		{
-			y = yoff;
+			y = fill.yoff;
 			z--;
 		}
 	}
+}
+
+namespace
+{
+
+/**
+ * A share of the deferred MAP blocks for one thread.
+ */
+struct FillBatch
+{
+	BattlescapeGenerator *generator;
+	size_t first, step;
+};
 
-	if (!mapFile.eof())
+}
+
+/**
+ * Fills in every step-th deferred block, starting at first.
+ * @param data Pointer to the FillBatch.
+ * @return Always 0.
+ */
+int BattlescapeGenerator::fillBlockBatch(void *data)
+{
+	FillBatch *batch = (FillBatch*)data;
+	std::vector<BlockFill> &fills = batch->generator->_pendingFills;
+	for (size_t i = batch->first; i < fills.size(); i += batch->step)
 	{
-		throw Exception("Invalid MAP file: " + filename.str());
+		batch->generator->fillBlock(fills[i]);
 	}
+	return 0;
+}
 
-	mapFile.close();
-
-	if (_generateFuel)
+/**
+ * Fills in the blocks loadMAP() deferred, spread over one thread
+ * per core. The blocks were placed on free spots of the block grid,
+ * so they never share tiles.
+ */
+void BattlescapeGenerator::fillPendingBlocks()
+{
+	size_t threads = std::min(_pendingFills.size(), (size_t)CrossPlatform::getNumberOfCores());
+	std::vector<FillBatch> batches(threads);
+	for (size_t i = 0; i < threads; ++i)
 	{
-		// if one of the mapBlocks has an items array defined, don't deploy fuel algorithmically
-		_generateFuel = mapblock->getItems()->empty();
+		batches[i].generator = this;
+		batches[i].first = i;
+		batches[i].step = threads;
 	}
-	for (std::map<std::string, std::vector<Position> >::const_iterator i = mapblock->getItems()->begin(); i != mapblock->getItems()->end(); ++i)
+
+	std::vector<SDL_Thread*> workers;
+	for (size_t i = 1; i < threads; ++i)
 	{
-		RuleItem *rule = _game->getMod()->getItem((*i).first, true);
-		for (std::vector<Position>::const_iterator j = (*i).second.begin(); j != (*i).second.end(); ++j)
+		SDL_Thread *thread = SDL_CreateThread(fillBlockBatch, &batches[i]);
+		if (thread == 0)
 		{
-			BattleItem *item = new BattleItem(rule, _save->getCurrentItemId());
-			_save->getItems()->push_back(item);
-			_save->getTile((*j) + Position(xoff, yoff, 0))->addItem(item, _game->getMod()->getInventory("STR_GROUND", true));
+			fillBlockBatch(&batches[i]);
+		}
+		else
+		{
+			workers.push_back(thread);
 		}
 	}
-	return sizez;
+	if (threads > 0)
+	{
+		fillBlockBatch(&batches[0]);
+	}
+	for (std::vector<SDL_Thread*>::iterator i = workers.begin(); i != workers.end(); ++i)
+	{
+		SDL_WaitThread(*i, 0);
+	}
+	_pendingFills.clear();
+	Tile::touchTerrain();
 }
 
 /**
@@ -1659,17 +1766,22 @@ void BattlescapeGenerator::loadRMP(MapBlock *mapblock, int xoff, int yoff, int s
 	filename << "ROUTES/" << mapblock->getName() << ".RMP";
 
 	// Load file
-	std::ifstream mapFile (FileMap::getFilePath(filename.str()).c_str(), std::ios::in| std::ios::binary);
+	const std::vector<Uint8> *mapFile = FileMap::getFileContents(filename.str());
 	if (!mapFile)
 	{
 		throw Exception(filename.str() + " not found");
 	}
+	if (mapFile->size() % sizeof(value) != 0)
+	{
+		Log(LOG_WARNING) << filename.str() << " has " << mapFile->size() % sizeof(value) << " bytes past its last node, ignoring them";
+	}
 
 	size_t nodeOffset = _save->getNodes()->size();
 	std::vector<int> badNodes;
 	int nodesAdded = 0;
-	while (mapFile.read((char*)&value, sizeof(value)))
+	for (size_t offset = 0; offset + sizeof(value) <= mapFile->size(); offset += sizeof(value))
 	{
+		memcpy(value, &(*mapFile)[offset], sizeof(value));
 		int pos_x = value[1];
 		int pos_y = value[0];
 		int pos_z = value[2];
@@ -1736,13 +1848,6 @@ void BattlescapeGenerator::loadRMP(MapBlock *mapblock, int xoff, int yoff, int s
 			nodeCounter--;
 		}
 	}
-
-	if (!mapFile.eof())
-	{
-		throw Exception("Invalid RMP file: " + filename.str());
-	}
-
-	mapFile.close();
 }
 
 /**
@@ -1968,6 +2073,8 @@ void BattlescapeGenerator::loadWeapons()
  */
 void BattlescapeGenerator::generateMap(const std::vector<MapScript*> *script)
 {
+	Uint32 generationStart = SDL_GetTicks();
+
 	// set our ambient sound
 	_save->setAmbientSound(_terrain->getAmbience());
 	_save->setAmbientVolume(_terrain->getAmbientVolume());
@@ -2142,6 +2249,8 @@ void BattlescapeGenerator::generateMap(const std::vector<MapScript*> *script)
 					success = true; // this command is fail-proof
 					break;
 				case MSC_FILLAREA:
+					// nothing looks at the tiles until the area is full, so fill them in all at once
+					_deferFills = true;
 					block = command->getNextBlock(_terrain);
 					while (block)
 					{
@@ -2156,6 +2265,8 @@ void BattlescapeGenerator::generateMap(const std::vector<MapScript*> *script)
 						}
 						block = command->getNextBlock(_terrain);
 					}
+					_deferFills = false;
+					fillPendingBlocks();
 					break;
 				case MSC_CHECKBLOCK:
 					for (std::vector<SDL_Rect*>::const_iterator k = command->getRects()->begin(); k != command->getRects()->end() && !success; ++k)
@@ -2308,6 +2419,8 @@ void BattlescapeGenerator::generateMap(const std::vector<MapScript*> *script)
 	}
 
 	attachNodeLinks();
+
+	Log(LOG_INFO) << "Generated " << _save->getMissionType() << " map on " << _terrain->getName() << " (" << _mapsize_x << "x" << _mapsize_y << "x" << _mapsize_z << ") in " << (SDL_GetTicks() - generationStart) << " ms";
 }
 
 /**
@@ -50,6 +50,15 @@ class Texture;
 class BattlescapeGenerator
 {
 private:
+	/// A MAP block that's been read and checked, waiting for its tiles to be filled in.
+	struct BlockFill
+	{
+		MapBlock *mapblock;
+		const std::vector<Uint8> *data;
+		RuleTerrain *terrain;
+		int xoff, yoff, z, mapDataSetOffset;
+		bool discovered;
+	};
 	Game *_game;
 	SavedBattleGame *_save;
 	Mod *_mod;
@@ -75,6 +84,8 @@ private:
 	std::vector< std::vector<bool> > _landingzone;
 	std::vector< std::vector<int> > _segments, _drillMap;
 	MapBlock *_dummy;
+	std::vector<BlockFill> _pendingFills;
+	bool _deferFills;
 
 	/// sets the map size and associated vars
 	void init(bool resetTerrain);
@@ -94,6 +105,12 @@ private:
 	bool addItem(BattleItem *item, BattleUnit *unit, bool allowSecondClip = false);
 	/// Loads an XCom MAP file.
 	int loadMAP(MapBlock *mapblock, int xoff, int yoff, RuleTerrain *terrain, int objectIDOffset, bool discovered = false, bool craft = false);
+	/// Fills in the tiles of a MAP block.
+	void fillBlock(const BlockFill &fill);
+	/// Fills in the deferred MAP blocks in parallel.
+	void fillPendingBlocks();
+	/// Fills in a share of the deferred MAP blocks.
+	static int fillBlockBatch(void *data);
 	/// Loads an XCom RMP file.
 	void loadRMP(MapBlock *mapblock, int xoff, int yoff, int segment);
 	/// Fills power sources with an alien fuel object.
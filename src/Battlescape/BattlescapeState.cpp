@@ -49,6 +49,7 @@
 #include "../Engine/Logger.h"
 #include "../Engine/Timer.h"
 #include "../Engine/CrossPlatform.h"
+#include "../Engine/Profiler.h"
 #include "../Interface/Cursor.h"
 #include "../Interface/Text.h"
 #include "../Interface/Bar.h"
@@ -155,6 +156,7 @@ BattlescapeState::BattlescapeState() : _reserve(0), _firstInit(true), _isMouseSc
 	_barMorale = new Bar(102, 3, x + 170, y + 53);
 
 	_txtDebug = new Text(300, 10, 20, 0);
+	_txtProfile = new Text(150, 100, 2, 10);
 	_txtTooltip = new Text(300, 10, x + 2, y - 10);
 
 	// Set palette
@@ -240,6 +242,7 @@ BattlescapeState::BattlescapeState() : _reserve(0), _firstInit(true), _isMouseSc
 	}
 	add(_warning, "warning", "battlescape", _icons);
 	add(_txtDebug);
+	add(_txtProfile);
 	add(_txtTooltip, "textTooltip", "battlescape", _icons);
 	add(_btnLaunch);
 	_game->getMod()->getSurfaceSet("SPICONS.DAT")->getFrame(0)->blit(_btnLaunch);
@@ -248,6 +251,13 @@ BattlescapeState::BattlescapeState() : _reserve(0), _firstInit(true), _isMouseSc
 
 	// Set up objects
 	_save = _game->getSavedGame()->getSavedBattle();
+	// decode the sprite sheets of every unit on the field now rather than mid-turn
+	std::vector<std::string> sheets;
+	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
+	{
+		sheets.push_back((*i)->getArmor()->getSpriteSheet());
+	}
+	_game->getMod()->preloadSurfaceSets(sheets);
 	_map->init();
 	_map->onMouseOver((ActionHandler)&BattlescapeState::mapOver);
 	_map->onMousePress((ActionHandler)&BattlescapeState::mapPress);
@@ -445,6 +455,10 @@ BattlescapeState::BattlescapeState() : _reserve(0), _firstInit(true), _isMouseSc
 	_txtDebug->setColor(Palette::blockOffset(8));
 	_txtDebug->setHighContrast(true);
 
+	_txtProfile->setColor(Palette::blockOffset(8));
+	_txtProfile->setHighContrast(true);
+	_txtProfile->setVisible(Profiler::isEnabled());
+
 	_txtTooltip->setHighContrast(true);
 
 	_btnReserveNone->setGroup(&_reserve);
@@ -568,6 +582,17 @@ void BattlescapeState::think()
 			_battleGame->think();
 			_animTimer->think(this, 0);
 			_gameTimer->think(this, 0);
+			if (Options::battleAutoPlay)
+			{
+				// don't wait for the animations, just stop now and then to draw a frame
+				Uint32 start = SDL_GetTicks();
+				UnitFaction side = _save->getSide();
+				while (_popups.empty() && _gameTimer->isRunning() && _save->getSide() == side && SDL_GetTicks() - start < AUTOPLAY_SLICE)
+				{
+					_battleGame->think();
+					handleState();
+				}
+			}
 			if (popped)
 			{
 				_battleGame->handleNonTargetAction();
@@ -585,6 +610,20 @@ void BattlescapeState::think()
 	}
 }
 
+/**
+ * Closes off the profiler's frame and shows its
+ * numbers, then draws the state as usual.
+ */
+void BattlescapeState::blit()
+{
+	if (Profiler::isEnabled())
+	{
+		Profiler::endFrame();
+		_txtProfile->setText(Profiler::getSummary());
+	}
+	State::blit();
+}
+
 /**
  * Processes any mouse moving over the map.
  * @param action Pointer to an action.
@@ -1600,6 +1639,22 @@ inline void BattlescapeState::handle(Action *action)
 							_save->getBattleGame()->handleState();
 						}
 					}
+					// "ctrl-u" - unit sprite cache statistics
+					else if (_save->getDebugMode() && action->getDetails()->key.keysym.sym == SDLK_u && (SDL_GetModState() & KMOD_CTRL) != 0)
+					{
+						size_t sprites, lookups, hits;
+						_map->getUnitSpriteStats(&sprites, &lookups, &hits);
+						std::wostringstream ss;
+						ss << L"Unit sprites: " << sprites << L" cached, " << (lookups ? hits * 100 / lookups : 0) << L"% hits";
+						debug(ss.str());
+					}
+					// "ctrl-p" - hot path profiler
+					else if (_save->getDebugMode() && action->getDetails()->key.keysym.sym == SDLK_p && (SDL_GetModState() & KMOD_CTRL) != 0)
+					{
+						Profiler::setEnabled(!Profiler::isEnabled());
+						_txtProfile->setVisible(Profiler::isEnabled());
+						debug(Profiler::isEnabled() ? L"Profiler on" : L"Profiler off");
+					}
 					// f11 - voxel map dump
 					else if (action->getDetails()->key.keysym.sym == SDLK_F11)
 					{
@@ -1963,6 +2018,12 @@ void BattlescapeState::saveVoxelMap()
  */
 void BattlescapeState::popup(State *state)
 {
+	// nobody is there to click them away
+	if (Options::battleAutoPlay)
+	{
+		delete state;
+		return;
+	}
 	_popups.push_back(state);
 }
 
@@ -2243,12 +2304,12 @@ void BattlescapeState::resize(int &dX, int &dY)
 
 	for (std::vector<Surface*>::const_iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
 	{
-		if (*i != _map && (*i) != _btnPsi && *i != _btnLaunch && *i != _txtDebug)
+		if (*i != _map && (*i) != _btnPsi && *i != _btnLaunch && *i != _txtDebug && *i != _txtProfile)
 		{
 			(*i)->setX((*i)->getX() + dX / 2);
 			(*i)->setY((*i)->getY() + dY);
 		}
-		else if (*i != _map && *i != _txtDebug)
+		else if (*i != _map && *i != _txtDebug && *i != _txtProfile)
 		{
 			(*i)->setX((*i)->getX() + dX);
 		}
@@ -66,7 +66,7 @@ private:
 	Bar *_barTimeUnits, *_barEnergy, *_barHealth, *_barMorale;
 	Timer *_animTimer, *_gameTimer;
 	SavedBattleGame *_save;
-	Text *_txtDebug, *_txtTooltip;
+	Text *_txtDebug, *_txtTooltip, *_txtProfile;
 	std::vector<State*> _popups;
 	BattlescapeGame *_battleGame;
 	bool _firstInit;
@@ -95,6 +95,7 @@ public:
 	/// Selects the previous soldier.
 	void selectPreviousPlayerUnit(bool checkReselect = false, bool setReselect = false, bool checkInventory = false);
 	static const int DEFAULT_ANIM_SPEED = 100;
+	static const Uint32 AUTOPLAY_SLICE = 50;
 	/// Creates the Battlescape state.
 	BattlescapeState();
 	/// Cleans up the Battlescape state.
@@ -103,6 +104,8 @@ public:
 	void init();
 	/// Runs the timers and handles popups.
 	void think();
+	/// Updates the profiler overlay and draws the state.
+	void blit();
 	/// Handler for moving mouse over the map.
 	void mapOver(Action *action);
 	/// Handler for pressing the map.
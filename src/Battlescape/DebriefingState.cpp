@@ -1410,7 +1410,7 @@ void DebriefingState::prepareDebriefing()
 			// reequip crafts (only those on the base) after a base defense mission
 			for (std::vector<Craft*>::iterator c = base->getCrafts()->begin(); c != base->getCrafts()->end(); ++c)
 			{
-				if ((*c)->getStatus() != "STR_OUT")
+				if ((*c)->getStatus() != Craft::STATUS_OUT)
 					reequipCraft(base, *c, false);
 			}
 			// Clear base->getVehicles() objects, they aren't needed anymore.
@@ -1473,22 +1473,12 @@ void DebriefingState::prepareDebriefing()
  */
 void DebriefingState::reequipCraft(Base *base, Craft *craft, bool vehicleItemsCanBeDestroyed)
 {
-	std::map<std::string, int> craftItems = *craft->getItems()->getContents();
-	for (std::map<std::string, int>::iterator i = craftItems.begin(); i != craftItems.end(); ++i)
+	std::map<std::string, int> missingItems = base->getStorageItems()->subtract(*craft->getItems());
+	for (std::map<std::string, int>::iterator i = missingItems.begin(); i != missingItems.end(); ++i)
 	{
-		int qty = base->getStorageItems()->getItem(i->first);
-		if (qty >= i->second)
-		{
-			base->getStorageItems()->removeItem(i->first, i->second);
-		}
-		else
-		{
-			int missing = i->second - qty;
-			base->getStorageItems()->removeItem(i->first, qty);
-			craft->getItems()->removeItem(i->first, missing);
-			ReequipStat stat = {i->first, missing, craft->getName(_game->getLanguage())};
-			_missingItems.push_back(stat);
-		}
+		craft->getItems()->removeItem(i->first, i->second);
+		ReequipStat stat = {i->first, i->second, craft->getName(_game->getLanguage())};
+		_missingItems.push_back(stat);
 	}
 
 	// Now let's see the vehicles
@@ -1502,7 +1492,8 @@ void DebriefingState::reequipCraft(Base *base, Craft *craft, bool vehicleItemsCa
 			delete (*i);
 	craft->getVehicles()->clear();
 	// Ok, now read those vehicles
-	for (std::map<std::string, int>::iterator i = craftVehicles.getContents()->begin(); i != craftVehicles.getContents()->end(); ++i)
+	std::map<std::string, int> vehicles = craftVehicles.getContents();
+	for (std::map<std::string, int>::iterator i = vehicles.begin(); i != vehicles.end(); ++i)
 	{
 		int qty = base->getStorageItems()->getItem(i->first);
 		RuleItem *tankRule = _game->getMod()->getItem(i->first, true);
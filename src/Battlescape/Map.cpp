@@ -17,6 +17,8 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <fstream>
+#include <functional>
+#include <set>
 #include "Map.h"
 #include "Camera.h"
 #include "UnitSprite.h"
@@ -34,6 +36,7 @@
 #include "../Engine/Palette.h"
 #include "../Engine/Game.h"
 #include "../Engine/Screen.h"
+#include "../Engine/Profiler.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Savegame/BattleUnit.h"
@@ -66,6 +69,23 @@
 namespace OpenXcom
 {
 
+namespace
+{
+
+/// Integer division rounding towards negative infinity.
+inline int floorDiv(int a, int b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/// Integer division rounding towards positive infinity.
+inline int ceilDiv(int a, int b)
+{
+	return -floorDiv(-a, b);
+}
+
+}
+
 /**
  * Sets up a map with the specified size and position.
  * @param game Pointer to the core game.
@@ -75,7 +95,7 @@ namespace OpenXcom
  * @param y Y position in pixels.
  * @param visibleMapHeight Current visible map height.
  */
-Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false)
+Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false), _unitSprite(0), _unitSpriteLookups(0), _unitSpriteHits(0)
 {
 	_iconHeight = _game->getMod()->getInterface("battlescape")->getElement("icons")->h;
 	_iconWidth = _game->getMod()->getInterface("battlescape")->getElement("icons")->w;
@@ -96,6 +116,12 @@ Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight)
 
 	_spriteWidth = _game->getMod()->getSurfaceSet("BLANKS.PCK")->getFrame(0)->getWidth();
 	_spriteHeight = _game->getMod()->getSurfaceSet("BLANKS.PCK")->getFrame(0)->getHeight();
+	_unitSprite = new UnitSprite(_spriteWidth * 2, _spriteHeight, 0, 0, _save->getDepth() != 0);
+	// the units' cached frames belong to the map, so they can't come from an old one
+	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
+	{
+		(*i)->invalidateCache();
+	}
 	_message = new BattlescapeMessage(320, (visibleMapHeight < 200)? visibleMapHeight : 200, 0, 0);
 	_message->setX(_game->getScreen()->getDX());
 	_message->setY((visibleMapHeight - _message->getHeight()) / 2);
@@ -125,6 +151,11 @@ Map::~Map()
 	delete _message;
 	delete _camera;
 	delete _txtAccuracy;
+	for (std::map<UnitSpriteKey, Surface*>::iterator i = _unitSprites.begin(); i != _unitSprites.end(); ++i)
+	{
+		delete i->second;
+	}
+	delete _unitSprite;
 }
 
 /**
@@ -243,6 +274,30 @@ void Map::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 	_message->setText(_game->getLanguage()->getString("STR_HIDDEN_MOVEMENT"));
 }
 
+/**
+ * Works out which tiles of a map column are on screen straight from the
+ * camera position, so drawTerrain doesn't have to project and test every
+ * tile of the map only to skip most of them.
+ * @param surface The surface being drawn on.
+ * @param x X coordinate of the column.
+ * @param z Level of the column.
+ * @param firstY Returns the first visible Y coordinate.
+ * @param lastY Returns the last visible Y coordinate, below firstY if there's none.
+ */
+void Map::getVisibleRows(Surface *surface, int x, int z, int *firstY, int *lastY) const
+{
+	const int halfWidth = _spriteWidth / 2, quarterWidth = _spriteWidth / 4;
+	const int levelHeight = (_spriteHeight + _spriteWidth / 4) / 2;
+	const Position offset = _camera->getMapOffset();
+	// the "inside the surface" test from drawTerrain, solved for y
+	const int left = x * halfWidth + offset.x;
+	const int top = z * levelHeight - offset.y - x * quarterWidth;
+	*firstY = std::max(floorDiv(left - surface->getWidth() - _spriteWidth, halfWidth), floorDiv(top - _spriteHeight, quarterWidth)) + 1;
+	*lastY = std::min(ceilDiv(left + _spriteWidth, halfWidth), ceilDiv(top + surface->getHeight() + _spriteHeight, quarterWidth)) - 1;
+	*firstY = std::max(*firstY, 0);
+	*lastY = std::min(*lastY, _save->getMapSizeY() - 1);
+}
+
 /**
  * Draw the terrain.
  * Keep this function as optimised as possible. It's big to minimise overhead of function calls.
@@ -250,6 +305,7 @@ void Map::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
  */
 void Map::drawTerrain(Surface *surface)
 {
+	Profiler::Scope profile(Profiler::PROF_DRAW_TERRAIN);
 	int frameNumber = 0;
 	Surface *tmpSurface;
 	Tile *tile;
@@ -377,6 +433,8 @@ void Map::drawTerrain(Surface *surface)
 		beginX = 0;
 	if (beginY < 0)
 		beginY = 0;
+	if (endX > _save->getMapSizeX() - 1)
+		endX = _save->getMapSizeX() - 1;
 
 	bool pathfinderTurnedOn = _save->getPathfinding()->isPathPreviewed();
 
@@ -392,7 +450,9 @@ void Map::drawTerrain(Surface *surface)
 	{
 		for (int itX = beginX; itX <= endX; itX++)
 		{
-			for (int itY = beginY; itY <= endY; itY++)
+			int firstY, lastY;
+			getVisibleRows(surface, itX, itZ, &firstY, &lastY);
+			for (int itY = std::max(beginY, firstY); itY <= std::min(endY, lastY); itY++)
 			{
 				mapPosition = Position(itX, itY, itZ);
 				_camera->convertMapToScreen(mapPosition, &screenPosition);
@@ -1120,7 +1180,9 @@ void Map::drawTerrain(Surface *surface)
 		{
 			for (int itX = beginX; itX <= endX; itX++)
 			{
-				for (int itY = beginY; itY <= endY; itY++)
+				int firstY, lastY;
+				getVisibleRows(surface, itX, itZ, &firstY, &lastY);
+				for (int itY = std::max(beginY, firstY); itY <= std::min(endY, lastY); itY++)
 				{
 					mapPosition = Position(itX, itY, itZ);
 					_camera->convertMapToScreen(mapPosition, &screenPosition);
@@ -1542,35 +1604,122 @@ void Map::cacheUnits()
  */
 void Map::cacheUnit(BattleUnit *unit)
 {
-	UnitSprite *unitSprite = new UnitSprite(_spriteWidth * 2, _spriteHeight, 0, 0, _save->getDepth() != 0);
-	unitSprite->setPalette(this->getPalette());
-	bool invalid, dummy;
-	int numOfParts = unit->getArmor()->getSize() * unit->getArmor()->getSize();
-
+	bool invalid;
 	unit->getCache(&invalid);
-	if (invalid)
+	if (!invalid)
+	{
+		return;
+	}
+	if (_unitSprites.size() >= UNIT_SPRITE_LIMIT)
+	{
+		evictUnitSprites();
+	}
+
+	// units that look the same share their frames, so compose each look only once
+	UnitSpriteKey key;
+	key.armor = unit->getArmor();
+	BattleItem *itemR = unit->getItem("STR_RIGHT_HAND"), *itemL = unit->getItem("STR_LEFT_HAND");
+	key.itemR = (itemR && !itemR->getRules()->isFixed()) ? itemR->getRules() : 0;
+	key.itemL = (itemL && !itemL->getRules()->isFixed()) ? itemL->getRules() : 0;
+	int state[] = { 0, unit->getStatus(), unit->getDirection(), unit->getTurretDirection(), unit->getTurretType(),
+		unit->getWalkingPhase(), unit->getFallingPhase(), unit->getStandHeight(), unit->getGender(), unit->getMovementType(),
+		unit->isFloating(), unit->isKneeled(), unit->getFloorAbove(), unit->getActiveHand() == "STR_LEFT_HAND",
+		UnitSprite::isAnimated(unit->getArmor()->getDrawingRoutine()) ? _animFrame : 0 };
+	key.state.assign(state, state + sizeof(state) / sizeof(state[0]));
+	if (Options::battleHairBleach)
+	{
+		key.recolor = unit->getRecolor();
+	}
+
+	// 1 or 4 iterations, depending on unit size
+	int numOfParts = unit->getArmor()->getSize() * unit->getArmor()->getSize();
+	for (int i = 0; i < numOfParts; i++)
 	{
-		// 1 or 4 iterations, depending on unit size
-		for (int i = 0; i < numOfParts; i++)
+		key.state[0] = i;
+		++_unitSpriteLookups;
+		Surface *cache;
+		std::map<UnitSpriteKey, Surface*>::iterator cached = _unitSprites.find(key);
+		if (cached != _unitSprites.end())
 		{
-			Surface *cache = unit->getCache(&dummy, i);
-			if (!cache) // no cache created yet
-			{
-				cache = new Surface(_spriteWidth * 2, _spriteHeight);
-				cache->setPalette(this->getPalette());
-			}
-			
-			unitSprite->setBattleUnit(unit, i);
-			unitSprite->setSurfaces(_game->getMod()->getSurfaceSet(unit->getArmor()->getSpriteSheet()),
+			++_unitSpriteHits;
+			cache = cached->second;
+		}
+		else
+		{
+			cache = new Surface(_spriteWidth * 2, _spriteHeight);
+			cache->setPalette(this->getPalette());
+			_unitSprite->setPalette(this->getPalette());
+			_unitSprite->setBattleUnit(unit, i);
+			_unitSprite->setSurfaces(_game->getMod()->getSurfaceSet(unit->getArmor()->getSpriteSheet()),
 									_game->getMod()->getSurfaceSet("HANDOB.PCK"),
 									_game->getMod()->getSurfaceSet("HANDOB2.PCK"));
-			unitSprite->setAnimationFrame(_animFrame);
-			cache->clear();
-			unitSprite->blit(cache);
-			unit->setCache(cache, i);
+			_unitSprite->setAnimationFrame(_animFrame);
+			_unitSprite->blit(cache);
+			_unitSprites[key] = cache;
+		}
+		unit->setCache(cache, i);
+	}
+}
+
+/**
+ * Frees the composited unit sprites that no unit points to anymore,
+ * so units already cached this pass keep their frames and still get drawn.
+ */
+void Map::evictUnitSprites()
+{
+	std::set<Surface*> shown;
+	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
+	{
+		int parts = (*i)->getArmor()->getSize() * (*i)->getArmor()->getSize();
+		for (int part = 0; part < parts; ++part)
+		{
+			bool invalid;
+			shown.insert((*i)->getCache(&invalid, part));
+		}
+	}
+	for (std::map<UnitSpriteKey, Surface*>::iterator i = _unitSprites.begin(); i != _unitSprites.end();)
+	{
+		if (shown.find(i->second) == shown.end())
+		{
+			delete i->second;
+			_unitSprites.erase(i++);
+		}
+		else
+		{
+			++i;
 		}
 	}
-	delete unitSprite;
+}
+
+/**
+ * Gets how well the shared unit sprite cache is doing, for debugging.
+ * @param sprites Returns the number of composited frames.
+ * @param lookups Returns the number of frames asked for.
+ * @param hits Returns the number of frames that were already there.
+ */
+void Map::getUnitSpriteStats(size_t *sprites, size_t *lookups, size_t *hits) const
+{
+	*sprites = _unitSprites.size();
+	*lookups = _unitSpriteLookups;
+	*hits = _unitSpriteHits;
+}
+
+/**
+ * Orders unit sprite keys so they can be looked up in a map.
+ * @param other Key to compare with.
+ * @return True if this key goes first.
+ */
+bool UnitSpriteKey::operator<(const UnitSpriteKey &other) const
+{
+	if (armor != other.armor)
+		return std::less<const Armor*>()(armor, other.armor);
+	if (itemR != other.itemR)
+		return std::less<const RuleItem*>()(itemR, other.itemR);
+	if (itemL != other.itemL)
+		return std::less<const RuleItem*>()(itemL, other.itemL);
+	if (state != other.state)
+		return state < other.state;
+	return recolor < other.recolor;
 }
 
 /**
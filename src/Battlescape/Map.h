@@ -21,6 +21,7 @@
 #include "../Engine/Options.h"
 #include "Position.h"
 #include <vector>
+#include <map>
 
 namespace OpenXcom
 {
@@ -35,8 +36,25 @@ class BattlescapeMessage;
 class Camera;
 class Timer;
 class Text;
+class UnitSprite;
+class Armor;
+class RuleItem;
 
 enum CursorType { CT_NONE, CT_NORMAL, CT_AIM, CT_PSI, CT_WAYPOINT, CT_THROW };
+
+/**
+ * Everything that decides what a composited unit sprite looks like,
+ * so units in the same pose can share one frame.
+ */
+struct UnitSpriteKey
+{
+	const Armor *armor;
+	const RuleItem *itemR, *itemL;
+	std::vector<int> state;
+	std::vector<std::pair<Uint8, Uint8> > recolor;
+	bool operator<(const UnitSpriteKey &other) const;
+};
+
 /**
  * Interactive map of the battlescape.
  */
@@ -45,6 +63,7 @@ class Map : public InteractiveSurface
 private:
 	static const int SCROLL_INTERVAL = 15;
 	static const int BULLET_SPRITES = 35;
+	static const size_t UNIT_SPRITE_LIMIT = 2048;
 	Timer *_scrollMouseTimer, *_scrollKeyTimer;
 	Game *_game;
 	SavedBattleGame *_save;
@@ -69,9 +88,16 @@ private:
 	SurfaceSet *_projectileSet;
 
 	void drawTerrain(Surface *surface);
+	void getVisibleRows(Surface *surface, int x, int z, int *firstY, int *lastY) const;
 	int getTerrainLevel(const Position& pos, int size) const;
 	int _iconHeight, _iconWidth, _messageColor;
 	const std::vector<Uint8> *_transparencies;
+	UnitSprite *_unitSprite;
+	std::map<UnitSpriteKey, Surface*> _unitSprites;
+	size_t _unitSpriteLookups, _unitSpriteHits;
+
+	/// Frees the composited unit sprites no unit is showing.
+	void evictUnitSprites();
 public:
 	/// Creates a new map at the specified position and size.
 	Map(Game* game, int width, int height, int x, int y, int visibleMapHeight);
@@ -111,6 +137,8 @@ public:
 	void cacheUnits();
 	/// Caches the unit.
 	void cacheUnit(BattleUnit *unit);
+	/// Gets the unit sprite cache statistics.
+	void getUnitSpriteStats(size_t *sprites, size_t *lookups, size_t *hits) const;
 	/// Sets projectile.
 	void setProjectile(Projectile *projectile);
 	/// Gets projectile.
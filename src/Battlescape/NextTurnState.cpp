@@ -122,7 +122,7 @@ NextTurnState::NextTurnState(SavedBattleGame *battleGame, BattlescapeState *stat
 
 	_state->clearMouseScrollingState();
 
-	if (Options::skipNextTurnScreen)
+	if (Options::skipNextTurnScreen || Options::battleAutoPlay)
 	{
 		_timer = new Timer(NEXT_TURN_DELAY);
 		_timer->onTimer((StateHandler)&NextTurnState::close);
@@ -19,11 +19,12 @@
  */
 #include <SDL_types.h>
 #include <algorithm>
+#include "../Engine/MemoryPool.h"
 
 namespace OpenXcom
 {
 
-class Particle
+class Particle : public PooledObject<Particle>
 {
 private:
 	float _xOffset, _yOffset, _density;
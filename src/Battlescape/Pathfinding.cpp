@@ -25,6 +25,7 @@
 #include "../Mod/Armor.h"
 #include "../Savegame/BattleUnit.h"
 #include "../Engine/Options.h"
+#include "../Engine/Profiler.h"
 #include "BattlescapeGame.h"
 
 namespace OpenXcom
@@ -38,8 +39,9 @@ int Pathfinding::green = 4;
  * Sets up a Pathfinding.
  * @param save pointer to SavedBattleGame object.
  */
-Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK)
+Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK), _prefetcher(0)
 {
+	_prefetch.unit = 0;
 	_size = _save->getMapSizeXYZ();
 	// Initialize one node per tile
 	_nodes.reserve(_size);
@@ -57,7 +59,7 @@ Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPr
  */
 Pathfinding::~Pathfinding()
 {
-	// Nothing more to do here.
+	delete _prefetcher;
 }
 
 /**
@@ -191,6 +193,7 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
  */
 bool Pathfinding::aStarPath(Position startPosition, Position endPosition, BattleUnit *target, bool sneak, int maxTUCost)
 {
+	Profiler::Scope profile(Profiler::PROF_PATHFINDING);
 	// reset every node, so we have to check them all
 	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
 		it->reset();
@@ -1153,6 +1156,27 @@ bool Pathfinding::bresenhamPath(Position origin, Position target, BattleUnit *ta
  * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
  */
 std::vector<int> Pathfinding::findReachable(BattleUnit *unit, int tuMax)
+{
+	if (_prefetch.unit == unit && collectPrefetch(unit))
+	{
+		std::vector<int>::const_iterator budget = std::find(_prefetch.budgets.begin(), _prefetch.budgets.end(), tuMax);
+		if (budget != _prefetch.budgets.end())
+		{
+			_unit = unit;
+			return _prefetch.results[budget - _prefetch.budgets.begin()];
+		}
+	}
+	Profiler::Scope profile(Profiler::PROF_REACHABLE);
+	return searchReachable(unit, tuMax);
+}
+
+/**
+ * Runs the Dijkstra search behind findReachable.
+ * @param unit Pointer to the unit.
+ * @param tuMax The maximum cost of the path to each tile.
+ * @return An array of reachable tiles, sorted in ascending order of cost.
+ */
+std::vector<int> Pathfinding::searchReachable(BattleUnit *unit, int tuMax)
 {
 	Position start = unit->getPosition();
 	int energyMax = unit->getEnergy();
@@ -1204,6 +1228,72 @@ std::vector<int> Pathfinding::findReachable(BattleUnit *unit, int tuMax)
 	return tiles;
 }
 
+/**
+ * Finds the tiles reachable to a unit before it gets to act, so the
+ * search can be done in a frame spent animating the previous unit
+ * rather than in the frame the unit thinks in. Runs on a private
+ * instance, between state updates, so nothing moves under it.
+ * The results are thrown away unless nothing they depend on has
+ * changed by the time the unit asks for them (see collectPrefetch).
+ * @param unit Pointer to the unit.
+ * @param budgets The TU limits findReachable will be called with.
+ */
+void Pathfinding::prefetchReachable(BattleUnit *unit, const std::vector<int> &budgets)
+{
+	// player units also depend on enemy visibility, which isn't tracked.
+	if (_strafeMove || unit->getFaction() == FACTION_PLAYER)
+		return;
+	if (_prefetch.unit == unit && _prefetch.budgets == budgets && collectPrefetch(unit))
+		return;
+	if (!_prefetcher)
+	{
+		_prefetcher = new Pathfinding(_save);
+	}
+	_prefetch.unit = unit;
+	_prefetch.position = unit->getPosition();
+	_prefetch.timeUnits = unit->getTimeUnits();
+	_prefetch.energy = unit->getEnergy();
+	_prefetch.faction = unit->getFaction();
+	_prefetch.spotted = unit->getUnitsSpottedThisTurn().size();
+	_prefetch.revision = Tile::getRevision();
+	_prefetch.movementType = _movementType;
+	_prefetch.budgets = budgets;
+	_prefetch.results.clear();
+	_prefetcher->_unit = unit;
+	_prefetcher->_movementType = _movementType;
+	Profiler::Scope profile(Profiler::PROF_REACHABLE);
+	for (std::vector<int>::const_iterator i = budgets.begin(); i != budgets.end(); ++i)
+	{
+		_prefetch.results.push_back(_prefetcher->searchReachable(unit, *i));
+	}
+}
+
+/**
+ * Checks the prefetched tiles are still what findReachable would
+ * return now. Anything that moved a unit, changed its side, the
+ * terrain, a door or a fire bumps the tile revision.
+ * @param unit Pointer to the unit.
+ * @return True if the prefetched results can be used.
+ */
+bool Pathfinding::collectPrefetch(BattleUnit *unit)
+{
+	if (_prefetch.unit != unit ||
+		_prefetch.position != unit->getPosition() ||
+		_prefetch.timeUnits != unit->getTimeUnits() ||
+		_prefetch.energy != unit->getEnergy() ||
+		_prefetch.faction != unit->getFaction() ||
+		_prefetch.spotted != unit->getUnitsSpottedThisTurn().size() ||
+		_prefetch.revision != Tile::getRevision() ||
+		_prefetch.movementType != _movementType ||
+		_strafeMove)
+	{
+		_prefetch.unit = 0;
+		_prefetch.results.clear();
+		return false;
+	}
+	return true;
+}
+
 /**
  * Gets the strafe move setting.
  * @return Strafe move.
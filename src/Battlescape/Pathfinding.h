@@ -44,6 +44,24 @@ private:
 	int _totalTUCost;
 	bool _modifierUsed;
 	MovementType _movementType;
+	/// Reachable tiles computed ahead of time for a unit that hasn't acted yet.
+	struct ReachablePrefetch
+	{
+		BattleUnit *unit;
+		Position position;
+		int timeUnits, energy, faction;
+		size_t spotted;
+		unsigned int revision;
+		MovementType movementType;
+		std::vector<int> budgets;
+		std::vector<std::vector<int> > results;
+	};
+	Pathfinding *_prefetcher;
+	ReachablePrefetch _prefetch;
+	/// Checks the prefetched tiles still match the battle.
+	bool collectPrefetch(BattleUnit *unit);
+	/// Searches for all reachable tiles.
+	std::vector<int> searchReachable(BattleUnit *unit, int tuMax);
 	/// Gets the node at certain position.
 	PathfindingNode *getNode(Position pos);
 	/// Determines whether a tile blocks a certain movementType.
@@ -99,6 +117,8 @@ public:
 	void setUnit(BattleUnit *unit);
 	/// Gets all reachable tiles, based on cost.
 	std::vector<int> findReachable(BattleUnit *unit, int tuMax);
+	/// Finds reachable tiles for a unit ahead of time.
+	void prefetchReachable(BattleUnit *unit, const std::vector<int> &budgets);
 	/// Gets _totalTUCost; finds out whether we can hike somewhere in this turn or not.
 	int getTotalTUCost() const { return _totalTUCost; }
 	/// Gets the path preview setting.
@@ -39,6 +39,7 @@
 #include "../Mod/Armor.h"
 #include "Pathfinding.h"
 #include "../Engine/Options.h"
+#include "../Engine/Profiler.h"
 #include "ProjectileFlyBState.h"
 #include "MeleeAttackBState.h"
 #include "../fmath.h"
@@ -53,7 +54,7 @@ const int TileEngine::heightFromCenter[11] = {0,-2,+2,-4,+4,-6,+6,-8,+8,-12,+12}
  * @param save Pointer to SavedBattleGame object.
  * @param voxelData List of voxel data.
  */
-TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData) : _save(save), _voxelData(voxelData), _personalLighting(true)
+TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData) : _save(save), _voxelData(voxelData), _personalLighting(true), _spotCacheRevision(0)
 {
 }
 
@@ -70,6 +71,7 @@ TileEngine::~TileEngine()
   */
 void TileEngine::calculateSunShading()
 {
+	Profiler::Scope profile(Profiler::PROF_LIGHTING);
 	const int layer = 0; // Ambient lighting layer.
 
 	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
@@ -114,6 +116,7 @@ void TileEngine::calculateSunShading(Tile *tile)
   */
 void TileEngine::calculateTerrainLighting()
 {
+	Profiler::Scope profile(Profiler::PROF_LIGHTING);
 	const int layer = 1; // Static lighting layer.
 	const int fireLightPower = 15; // amount of light a fire generates
 
@@ -161,6 +164,7 @@ void TileEngine::calculateTerrainLighting()
   */
 void TileEngine::calculateUnitLighting()
 {
+	Profiler::Scope profile(Profiler::PROF_LIGHTING);
 	const int layer = 2; // Dynamic lighting layer.
 	const int personalLightPower = 15; // amount of light a unit generates
 	const int fireLightPower = 15; // amount of light a fire generates
@@ -226,6 +230,7 @@ void TileEngine::addLight(Position center, int power, int layer)
  */
 bool TileEngine::calculateFOV(BattleUnit *unit)
 {
+	Profiler::Scope profile(Profiler::PROF_FOV);
 	size_t oldNumVisibleUnits = unit->getUnitsSpottedThisTurn().size();
 	Position center = unit->getPosition();
 	Position test;
@@ -623,6 +628,132 @@ bool TileEngine::canTargetUnit(Position *originVoxel, Tile *tile, Position *scan
 	return false;
 }
 
+/**
+ * Checks whether a unit could target a hypothetical unit standing on a
+ * tile, like canTargetUnit, but remembers the answer. The AI asks this
+ * for the same observers and tiles over and over while scoring ambush,
+ * escape and fire positions, so each one gets traced once.
+ * The answer depends on the target's shape and on where the target
+ * really stands (canTargetUnit offsets the hit box by it), so both
+ * are part of the key along with the observer.
+ * An observer's entries are dropped when its sight origin changes.
+ * When units move or terrain changes, only the entries whose lines
+ * of sight pass by the changed tiles are dropped, see forgetSpots.
+ * Everything is dropped at each new turn.
+ * @param originVoxel Voxel of trace origin (eye).
+ * @param tile The tile to check for.
+ * @param excludeUnit The observer (not to hit self).
+ * @param potentialUnit The unit that would stand on the tile.
+ * @return True if the unit can be targetted.
+ */
+bool TileEngine::canTargetUnitCached(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *potentialUnit)
+{
+	if (_spotCacheRevision != Tile::getRevision())
+	{
+		std::vector<Position> changes;
+		if (Tile::getChangesSince(_spotCacheRevision, &changes))
+		{
+			forgetSpots(changes);
+			_spotCacheRevision = Tile::getRevision();
+		}
+		else
+		{
+			clearSpotCache();
+		}
+	}
+	// the target's shape is all canTargetUnit uses of the hypothetical unit
+	int height = potentialUnit->isOut() ? 12 : potentialUnit->getHeight();
+	int shape = potentialUnit->getFloatHeight() | (height << 8) | (potentialUnit->getLoftemps() << 16) | (potentialUnit->getArmor()->getSize() << 24);
+	int standing = _save->getTileIndex(potentialUnit->getPosition());
+	SpotColumn &column = _spotCache[std::make_pair(excludeUnit, std::make_pair(shape, standing))];
+	if (column.origin != *originVoxel)
+	{
+		column.origin = *originVoxel;
+		column.tiles.clear();
+	}
+	int index = _save->getTileIndex(tile->getPosition());
+	std::map<int, bool>::iterator seen = column.tiles.find(index);
+	if (seen == column.tiles.end())
+	{
+		Position scanVoxel;
+		seen = column.tiles.insert(std::make_pair(index, canTargetUnit(originVoxel, tile, &scanVoxel, excludeUnit, potentialUnit))).first;
+	}
+	return seen->second;
+}
+
+/**
+ * Forgets the cached targeting checks whose lines of sight pass by any
+ * of the changed tiles, so a unit stepping into or out of the way (or a
+ * wall going down) only costs the checks it could have changed.
+ * The traces of a check fan out a little around the line between the
+ * eye and the target tile's center and can end up on the level below,
+ * so a tile counts as in the way when its center is within a tile and
+ * a half of that line and it is no more than a level above or below it.
+ * @param changes Positions of the tiles that changed.
+ */
+void TileEngine::forgetSpots(const std::vector<Position> &changes)
+{
+	const int reach = 24;
+	for (std::map<std::pair<BattleUnit*, std::pair<int, int> >, SpotColumn>::iterator i = _spotCache.begin(); i != _spotCache.end(); ++i)
+	{
+		SpotColumn &column = i->second;
+		Position eye = column.origin;
+		for (std::map<int, bool>::iterator j = column.tiles.begin(); j != column.tiles.end();)
+		{
+			Position target;
+			_save->getTileCoords(j->first, &target.x, &target.y, &target.z);
+			int lowest = std::min(eye.z / 24, target.z) - 1;
+			int highest = std::max(eye.z / 24, target.z) + 1;
+			int dx = target.x * 16 + 8 - eye.x;
+			int dy = target.y * 16 + 8 - eye.y;
+			int length = dx * dx + dy * dy;
+			bool inTheWay = false;
+			for (std::vector<Position>::const_iterator k = changes.begin(); k != changes.end() && !inTheWay; ++k)
+			{
+				if (k->z < lowest || k->z > highest)
+					continue;
+				int px = k->x * 16 + 8 - eye.x;
+				int py = k->y * 16 + 8 - eye.y;
+				int along = px * dx + py * dy;
+				if (along <= 0)
+				{
+					// behind the eye, or level with it
+					inTheWay = px * px + py * py <= reach * reach;
+				}
+				else if (along >= length)
+				{
+					// past the target
+					inTheWay = (px - dx) * (px - dx) + (py - dy) * (py - dy) <= reach * reach;
+				}
+				else
+				{
+					// beside the line: squared distance is cross^2 / length
+					float cross = (float)(px * dy - py * dx);
+					inTheWay = cross * cross <= (float)reach * reach * length;
+				}
+			}
+			if (inTheWay)
+			{
+				column.tiles.erase(j++);
+			}
+			else
+			{
+				++j;
+			}
+		}
+	}
+}
+
+/**
+ * Forgets all the cached targeting checks, at the start of a new turn
+ * or when too much has changed to forget them one by one.
+ */
+void TileEngine::clearSpotCache()
+{
+	_spotCache.clear();
+	_spotCacheRevision = Tile::getRevision();
+}
+
 /**
  * Checks for a tile part available for targeting and what particular voxel.
  * @param originVoxel Voxel of trace origin (gun's barrel).
@@ -850,18 +981,22 @@ std::vector<std::pair<BattleUnit *, int> > TileEngine::getSpottingUnits(BattleUn
 				// closer than 20 tiles
 				distanceSq(unit->getPosition(), (*i)->getPosition()) <= MAX_VIEW_DISTANCE_SQR)
 			{
+				AIModule *ai = (*i)->getAIModule();
+				bool gotHit = (ai != 0 && ai->getWasHitBy(unit->getId()));
+				// can actually see the target Tile, or we got hit
+				// (checked before anything voxel based, most enemies are facing elsewhere)
+				if (!gotHit && !inViewCone(*i, unit->getPosition()))
+				{
+					continue;
+				}
 				BattleAction falseAction;
 				falseAction.type = BA_SNAPSHOT;
 				falseAction.actor = *i;
 				falseAction.target = unit->getPosition();
 				Position originVoxel = getOriginVoxel(falseAction, 0);
 				Position targetVoxel;
-				AIModule *ai = (*i)->getAIModule();
-				bool gotHit = (ai != 0 && ai->getWasHitBy(unit->getId()));
-					// can actually see the target Tile, or we got hit
-				if (((*i)->checkViewSector(unit->getPosition()) || gotHit) &&
-					// can actually target the unit
-					canTargetUnit(&originVoxel, tile, &targetVoxel, *i) &&
+				// can actually target the unit
+				if (canTargetUnit(&originVoxel, tile, &targetVoxel, *i) &&
 					// can actually see the unit
 					visible(*i, tile))
 				{
@@ -882,6 +1017,43 @@ std::vector<std::pair<BattleUnit *, int> > TileEngine::getSpottingUnits(BattleUn
 	return spotters;
 }
 
+/**
+ * Checks whether a position is in a unit's view cone, same as
+ * BattleUnit::checkViewSector, but from a mask of the tiles in the
+ * cone out to view distance. The mask is kept for each unit and only
+ * worked out again once the unit has turned or moved, while units
+ * standing watch get asked about every step of every move.
+ * @param unit The unit looking.
+ * @param pos The position to check.
+ * @return True if the position is in the view cone.
+ */
+bool TileEngine::inViewCone(BattleUnit *unit, Position pos)
+{
+	const int size = MAX_VIEW_DISTANCE * 2 + 1;
+	Position origin = unit->getPosition();
+	int x = pos.x - origin.x + MAX_VIEW_DISTANCE;
+	int y = pos.y - origin.y + MAX_VIEW_DISTANCE;
+	if (x < 0 || x >= size || y < 0 || y >= size)
+	{
+		return unit->checkViewSector(pos);
+	}
+	ViewCone &cone = _viewCones[unit];
+	if (cone.tiles.empty() || cone.position != origin || cone.direction != unit->getDirection())
+	{
+		cone.position = origin;
+		cone.direction = unit->getDirection();
+		cone.tiles.resize(size * size);
+		for (int j = 0; j < size; ++j)
+		{
+			for (int i = 0; i < size; ++i)
+			{
+				cone.tiles[j * size + i] = unit->checkViewSector(Position(origin.x + i - MAX_VIEW_DISTANCE, origin.y + j - MAX_VIEW_DISTANCE, origin.z));
+			}
+		}
+	}
+	return cone.tiles[y * size + x];
+}
+
 /**
  * Gets the unit with the highest reaction score from the spotter vector.
  * @param spotters The vector of spotting units.
@@ -1144,6 +1316,7 @@ BattleUnit *TileEngine::hit(Position center, int power, ItemDamageType type, Bat
  */
 void TileEngine::explode(Position center, int power, ItemDamageType type, int maxRadius, BattleUnit *unit)
 {
+	Profiler::Scope profile(Profiler::PROF_EXPLODE);
 	double centerZ = center.z / 24 + 0.5;
 	double centerX = center.x / 16 + 0.5;
 	double centerY = center.y / 16 + 0.5;
@@ -2140,6 +2313,7 @@ int TileEngine::closeUfoDoors()
  */
 int TileEngine::calculateLine(Position origin, Position target, bool storeTrajectory, std::vector<Position> *trajectory, BattleUnit *excludeUnit, bool doVoxelCheck, bool onlyVisible, BattleUnit *excludeAllBut)
 {
+	Profiler::Scope profile(Profiler::PROF_LINE);
 	int x, x0, x1, delta_x, step_x;
 	int y, y0, y1, delta_y, step_y;
 	int z, z0, z1, delta_z, step_z;
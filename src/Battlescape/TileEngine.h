@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <map>
 #include "Position.h"
 #include "../Mod/RuleItem.h"
 #include <SDL.h>
@@ -47,6 +48,26 @@ private:
 	void addLight(Position center, int power, int layer);
 	int blockage(Tile *tile, const int part, ItemDamageType type, int direction = -1, bool checkingFromOrigin = false);
 	bool _personalLighting;
+	/// What one unit could target from where it stands, see canTargetUnitCached.
+	struct SpotColumn
+	{
+		Position origin;
+		std::map<int, bool> tiles;
+	};
+	std::map<std::pair<BattleUnit*, std::pair<int, int> >, SpotColumn> _spotCache;
+	unsigned int _spotCacheRevision;
+	/// Forgets the cached targeting checks that look past the changed tiles.
+	void forgetSpots(const std::vector<Position> &changes);
+	/// The tiles around a unit that are in its view cone, see inViewCone.
+	struct ViewCone
+	{
+		Position position;
+		int direction;
+		std::vector<bool> tiles;
+	};
+	std::map<BattleUnit*, ViewCone> _viewCones;
+	/// Checks whether a position is in a unit's view cone.
+	bool inViewCone(BattleUnit *unit, Position pos);
 public:
 	/// Creates a new TileEngine class.
 	TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData);
@@ -106,6 +127,10 @@ public:
 	int checkVoxelExposure(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *excludeAllBut);
 	/// Checks validity for targetting a unit.
 	bool canTargetUnit(Position *originVoxel, Tile *tile, Position *scanVoxel, BattleUnit *excludeUnit, BattleUnit *potentialUnit = 0);
+	/// Checks whether a unit could target a hypothetical unit on a tile, remembering the result until something in the way changes.
+	bool canTargetUnitCached(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *potentialUnit);
+	/// Forgets the cached targeting checks.
+	void clearSpotCache();
 	/// Check validity for targetting a tile.
 	bool canTargetTile(Position *originVoxel, Tile *tile, int part, Position *scanVoxel, BattleUnit *excludeUnit);
 	/// Calculates the z voxel for shadows.
@@ -165,6 +165,32 @@ void UnitSprite::setAnimationFrame(int frame)
 	_animationFrame = frame;
 }
 
+/**
+ * Checks if units drawn with a given routine change with the
+ * animation frame, or always look the same in the same pose.
+ * @param drawingRoutine Drawing routine of the unit's armor.
+ * @return True if the animation frame is used.
+ */
+bool UnitSprite::isAnimated(int drawingRoutine)
+{
+	// every entry in draw()'s table whose routine reads _animationFrame
+	switch (drawingRoutine)
+	{
+	case 2: // xcom tanks
+	case 3: // cyberdiscs
+	case 8: // silacoids
+	case 9: // celatids
+	case 11: // tftd tanks
+	case 12: // hallucinoids
+	case 16: // biodrones
+	case 21: // xarquids
+	case 22: // helicopters
+		return true;
+	default:
+		return false;
+	}
+}
+
 /**
  * Draws a unit, using the drawing rules of the unit.
  * This function is called by Map, for each unit on the screen.
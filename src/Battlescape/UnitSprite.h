@@ -90,6 +90,8 @@ public:
 	void setBattleUnit(BattleUnit *unit, int part = 0);
 	/// Sets the animation frame.
 	void setAnimationFrame(int frame);
+	/// Checks if a drawing routine depends on the animation frame.
+	static bool isAnimated(int drawingRoutine);
 	/// Draws the unit.
 	void draw();
 };
@@ -37,6 +37,12 @@
 namespace OpenXcom
 {
 
+namespace
+{
+/// How long a hidden unit may keep walking within one frame, in milliseconds.
+const Uint32 HIDDEN_WALK_BUDGET = 10;
+}
+
 /**
  * Sets up an UnitWalkBState.
  * @param parent Pointer to the Battlescape.
@@ -76,8 +82,44 @@ void UnitWalkBState::init()
 
 /**
  * Runs state functionality every cycle.
+ * While nobody can see the unit there is nothing to animate, so it
+ * keeps stepping within the same frame instead of one phase per
+ * frame. Every tile still goes through the usual FOV, proximity
+ * grenade and reaction fire checks, and as soon as the unit is
+ * spotted it goes back to walking at animation speed.
  */
 void UnitWalkBState::think()
+{
+	Uint32 start = SDL_GetTicks();
+	while (true)
+	{
+		Position position = _unit->getPosition();
+		UnitStatus status = _unit->getStatus();
+		int phase = _unit->getWalkingPhase();
+		int direction = _unit->getDirection();
+		step();
+		if (!isHidden() || !_parent->isCurrentState(this) || SDL_GetTicks() - start >= HIDDEN_WALK_BUDGET)
+			break;
+		// nothing happened, we're waiting on something (eg. a ufo door)
+		if (position == _unit->getPosition() && status == _unit->getStatus() && phase == _unit->getWalkingPhase() && direction == _unit->getDirection())
+			break;
+	}
+}
+
+/**
+ * Checks whether the walk can skip its animation, ie. the
+ * unit is an enemy or civilian no player unit can see.
+ * @return True if the unit is hidden.
+ */
+bool UnitWalkBState::isHidden() const
+{
+	return !_unit->getVisible() && _unit->getFaction() != FACTION_PLAYER && !_unit->isOut() && !_parent->getSave()->getDebugMode();
+}
+
+/**
+ * Advances the walk by one animation frame.
+ */
+void UnitWalkBState::step()
 {
 	bool unitSpotted = false;
 	int size = _unit->getArmor()->getSize() - 1;
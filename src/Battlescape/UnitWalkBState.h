@@ -47,6 +47,10 @@ private:
 	void setNormalWalkSpeed();
 	/// Handles the stepping sounds.
 	void playMovementSound();
+	/// Advances the walk by one animation frame.
+	void step();
+	/// Checks whether there's anything to animate.
+	bool isHidden() const;
 	std::size_t _numUnitsSpotted;
 	int _preMovementCost;
 public:
@@ -23,6 +23,7 @@
 #include <exception>
 #include <algorithm>
 #include <sstream>
+#include <fstream>
 #include <string>
 #include <locale>
 #include <stdint.h>
@@ -43,6 +44,7 @@
 #include <shlobj.h>
 #include <shlwapi.h>
 #include <dbghelp.h>
+#include <psapi.h>
 #ifndef SHGFP_TYPE_CURRENT
 #define SHGFP_TYPE_CURRENT 0
 #endif
@@ -52,6 +54,7 @@
 #pragma comment(lib, "shell32.lib")
 #pragma comment(lib, "shlwapi.lib")
 #pragma comment(lib, "dbghelp.lib")
+#pragma comment(lib, "psapi.lib")
 #endif
 #else
 #include <iostream>
@@ -65,6 +68,7 @@
 #include <sys/types.h>
 #include <pwd.h>
 #include <execinfo.h>
+#include <sys/resource.h>
 #endif
 #include <SDL.h>
 #include <SDL_syswm.h>
@@ -1097,6 +1101,78 @@ void crashDump(void *ex, const std::string &err)
 	showError(msg.str());
 }
 
+/**
+ * Gets the number of processor cores available
+ * to the game, used to size worker thread pools.
+ * @return Number of cores (at least 1).
+ */
+int getNumberOfCores()
+{
+	int cores = 1;
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	cores = (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return std::max(1, cores);
+}
+
+/**
+ * Gets the most memory the game has had resident at
+ * once so far, for logging how heavy a battle was.
+ * @return Peak resident set size in KB, or 0 if unknown.
+ */
+size_t getPeakMemoryUsage()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return (size_t)counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#ifdef __APPLE__
+	return (size_t)usage.ru_maxrss / 1024;
+#else
+	return (size_t)usage.ru_maxrss;
+#endif
+#endif
+}
+
+/**
+ * Reads the whole contents of a file into memory
+ * with a single read, for decoding it in place.
+ * @param path Full path to the file.
+ * @param data Returns the file contents.
+ * @return True if the file was read.
+ */
+bool readFile(const std::string &path, std::vector<Uint8> &data)
+{
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	file.seekg(0, std::ios::end);
+	std::streamoff size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	data.resize((size_t)std::max(size, (std::streamoff)0));
+	if (!data.empty())
+	{
+		file.read((char*)&data[0], data.size());
+		data.resize((size_t)file.gcount());
+	}
+	return true;
+}
+
 }
 
 }
@@ -97,6 +97,12 @@ namespace CrossPlatform
 	std::string now();
 	/// Produces a crash dump.
 	void crashDump(void *ex, const std::string &err);
+	/// Gets the number of processor cores.
+	int getNumberOfCores();
+	/// Reads the whole contents of a file.
+	bool readFile(const std::string &path, std::vector<Uint8> &data);
+	/// Gets the peak memory use of the game.
+	size_t getPeakMemoryUsage();
 }
 
 }
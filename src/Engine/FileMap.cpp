@@ -32,6 +32,7 @@ static std::vector<std::pair<std::string, std::vector<std::string> > > _rulesets
 static std::map<std::string, std::string> _resources;
 static std::map< std::string, std::set<std::string> > _vdirs;
 static std::set<std::string> _emptySet;
+static std::map<std::string, std::vector<Uint8> > _contents;
 
 static std::string _canonicalize(const std::string &in)
 {
@@ -52,6 +53,23 @@ const std::string &getFilePath(const std::string &relativeFilePath)
 	return _resources.at(canonicalRelativeFilePath);
 }
 
+const std::vector<Uint8> *getFileContents(const std::string &relativeFilePath)
+{
+	std::string canonicalRelativeFilePath = _canonicalize(relativeFilePath);
+	std::map<std::string, std::vector<Uint8> >::iterator i = _contents.find(canonicalRelativeFilePath);
+	if (i == _contents.end())
+	{
+		std::vector<Uint8> data;
+		if (!CrossPlatform::readFile(getFilePath(relativeFilePath), data))
+		{
+			return 0;
+		}
+		i = _contents.insert(std::make_pair(canonicalRelativeFilePath, std::vector<Uint8>())).first;
+		i->second.swap(data);
+	}
+	return &i->second;
+}
+
 const std::set<std::string> &getVFolderContents(const std::string &relativePath)
 {
 	std::string canonicalRelativePath = _canonicalize(relativePath);
@@ -178,6 +196,7 @@ void clear()
 	_rulesets.clear();
 	_resources.clear();
 	_vdirs.clear();
+	_contents.clear();
 }
 
 void load(const std::string &modId, const std::string &path, bool ignoreMods)
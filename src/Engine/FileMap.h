@@ -20,6 +20,7 @@
 #include <set>
 #include <string>
 #include <vector>
+#include <SDL_types.h>
 
 namespace OpenXcom
 {
@@ -35,6 +36,11 @@ namespace FileMap
 	/// path is returned verbatim (for use in error messages when the file is ultimately not found).
 	const std::string &getFilePath(const std::string &relativeFilePath);
 
+	/// Gets the whole contents of a data file, reading it on first use and keeping it in memory until the
+	/// next clear().  Meant for small files that are decoded again every battle, like MAP, RMP and MCD files.
+	/// Returns 0 if the file can't be read.
+	const std::vector<Uint8> *getFileContents(const std::string &relativeFilePath);
+
 	/// Returns the set of files in a virtual folder.  The virtual folder contains files from all active mods
 	/// that are in similarly-named subdirectories.  The returned file names can then be translated to real
 	/// filesystem paths via getFilePath()
@@ -196,6 +196,9 @@ void Game::run()
 							break;
 					}
 					break;
+				case SDL_VIDEOEXPOSE:
+					_screen->invalidate();
+					break;
 				case SDL_VIDEORESIZE:
 					if (Options::allowResize)
 					{
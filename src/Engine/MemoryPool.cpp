@@ -0,0 +1,133 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MemoryPool.h"
+#include <algorithm>
+#include <new>
+
+namespace OpenXcom
+{
+
+std::vector<MemoryPool*> *MemoryPool::_pools = 0;
+
+/**
+ * Creates an empty pool. Blocks are padded so every one of
+ * them is suitably aligned for any of the pooled objects.
+ * @param blockSize Size of each block in bytes.
+ * @param chunkBlocks Number of blocks allocated at once.
+ */
+MemoryPool::MemoryPool(size_t blockSize, size_t chunkBlocks) : _blockSize(0), _chunkBlocks(chunkBlocks), _live(0), _free(0)
+{
+	const size_t align = 16;
+	_blockSize = (std::max(blockSize, sizeof(void*)) + align - 1) / align * align;
+	if (_pools == 0)
+	{
+		_pools = new std::vector<MemoryPool*>();
+	}
+	_pools->push_back(this);
+}
+
+/**
+ * Frees the chunks, unless something still lives in them.
+ */
+MemoryPool::~MemoryPool()
+{
+	release();
+	_pools->erase(std::find(_pools->begin(), _pools->end(), this));
+	if (_pools->empty())
+	{
+		delete _pools;
+		_pools = 0;
+	}
+}
+
+/**
+ * Allocates a new chunk and threads its blocks onto the free list,
+ * in address order so consecutive allocations end up next to each other.
+ */
+void MemoryPool::grow()
+{
+	char *chunk = static_cast<char*>(::operator new(_blockSize * _chunkBlocks));
+	_chunks.push_back(chunk);
+	for (size_t i = _chunkBlocks; i-- > 0;)
+	{
+		void *block = chunk + i * _blockSize;
+		*static_cast<void**>(block) = _free;
+		_free = block;
+	}
+}
+
+/**
+ * Gets a free block, growing the pool if it's out of them.
+ * @return Pointer to the block.
+ */
+void *MemoryPool::allocate()
+{
+	if (_free == 0)
+	{
+		grow();
+	}
+	void *block = _free;
+	_free = *static_cast<void**>(block);
+	++_live;
+	return block;
+}
+
+/**
+ * Puts a block back on the free list.
+ * @param block Pointer to the block.
+ */
+void MemoryPool::deallocate(void *block)
+{
+	if (block == 0)
+		return;
+	*static_cast<void**>(block) = _free;
+	_free = block;
+	--_live;
+}
+
+/**
+ * Frees all the chunks at once, if none of their blocks are in use.
+ */
+void MemoryPool::release()
+{
+	if (_live != 0)
+		return;
+	for (std::vector<char*>::iterator i = _chunks.begin(); i != _chunks.end(); ++i)
+	{
+		::operator delete(*i);
+	}
+	_chunks.clear();
+	_free = 0;
+}
+
+/**
+ * Frees the chunks of every pool with nothing left in it,
+ * called once all the battle objects have been deleted.
+ */
+void MemoryPool::releaseAll()
+{
+	if (_pools == 0)
+		return;
+	for (std::vector<MemoryPool*>::iterator i = _pools->begin(); i != _pools->end(); ++i)
+	{
+		(*i)->release();
+	}
+}
+
+}
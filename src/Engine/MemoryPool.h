@@ -0,0 +1,98 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <vector>
+#include <new>
+
+namespace OpenXcom
+{
+
+/**
+ * Hands out fixed-size blocks carved from big chunks, for the objects
+ * a battle creates and destroys by the thousand. Freed blocks are kept
+ * for reuse, and every pool gives its chunks back in one go with
+ * releaseAll() once the battle is over. Not thread-safe.
+ */
+class MemoryPool
+{
+private:
+	size_t _blockSize, _chunkBlocks, _live;
+	std::vector<char*> _chunks;
+	void *_free;
+	static std::vector<MemoryPool*> *_pools;
+	/// Adds another chunk of blocks to the free list.
+	void grow();
+	/// Frees the chunks if no blocks are in use.
+	void release();
+public:
+	/// Creates a pool for blocks of a given size.
+	MemoryPool(size_t blockSize, size_t chunkBlocks = 512);
+	/// Cleans up the pool.
+	~MemoryPool();
+	/// Gets a block from the pool.
+	void *allocate();
+	/// Returns a block to the pool.
+	void deallocate(void *block);
+	/// Gets the size of the blocks in the pool.
+	size_t getBlockSize() const { return _blockSize; }
+	/// Frees the chunks of every pool that's no longer in use.
+	static void releaseAll();
+};
+
+/**
+ * Base for classes whose objects come out of a MemoryPool of their own,
+ * so all the objects of a battle sit together instead of all over the heap.
+ * Derived classes too big for the pool's blocks go to the heap instead.
+ */
+template <class T>
+class PooledObject
+{
+private:
+	/// Gets the pool for this class, creating it on first use.
+	static MemoryPool &getPool()
+	{
+		static MemoryPool pool(sizeof(T));
+		return pool;
+	}
+public:
+	/// Allocates an object from the pool.
+	static void *operator new(size_t size)
+	{
+		if (size > getPool().getBlockSize())
+		{
+			return ::operator new(size);
+		}
+		return getPool().allocate();
+	}
+	/// Returns an object to the pool.
+	static void operator delete(void *p, size_t size)
+	{
+		if (size > getPool().getBlockSize())
+		{
+			::operator delete(p);
+		}
+		else
+		{
+			getPool().deallocate(p);
+		}
+	}
+};
+
+}
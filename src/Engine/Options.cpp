@@ -51,6 +51,7 @@ std::string _configFolder;
 std::vector<std::string> _userList;
 std::map<std::string, std::string> _commandLine;
 std::vector<OptionInfo> _info;
+std::vector<OptionInfo> _argInfo;
 std::map<std::string, ModInfo> _modInfos;
 
 /**
@@ -74,6 +75,7 @@ void create()
 
 	_info.push_back(OptionInfo("maxFrameSkip", &maxFrameSkip, 0));
 	_info.push_back(OptionInfo("traceAI", &traceAI, false));
+	_info.push_back(OptionInfo("battleProfiler", &battleProfiler, false));
 	_info.push_back(OptionInfo("verboseLogging", &verboseLogging, false));
 	_info.push_back(OptionInfo("StereoSound", &StereoSound, true));
 	//_info.push_back(OptionInfo("baseXResolution", &baseXResolution, Screen::ORIGINAL_WIDTH));
@@ -87,6 +89,7 @@ void create()
 	_info.push_back(OptionInfo("useScaleFilter", &useScaleFilter, false));
 	_info.push_back(OptionInfo("useHQXFilter", &useHQXFilter, false));
 	_info.push_back(OptionInfo("useXBRZFilter", &useXBRZFilter, false));
+	_info.push_back(OptionInfo("scalerThreads", &scalerThreads, 0)); // 0 = one per core
 	_info.push_back(OptionInfo("useOpenGL", &useOpenGL, false));
 	_info.push_back(OptionInfo("checkOpenGLErrors", &checkOpenGLErrors, false));
 	_info.push_back(OptionInfo("useOpenGLShader", &useOpenGLShader, "Shaders/Raw.OpenGL.shader"));
@@ -287,6 +290,10 @@ void create()
 	_info.push_back(OptionInfo("FPSInactive", &FPSInactive, 30, "STR_FPS_INACTIVE_LIMIT", "STR_GENERAL"));
 #endif
 
+	// battle debugging switches, only set from the command line and never saved
+	_argInfo.push_back(OptionInfo("battleAutoPlay", &battleAutoPlay, false));
+	_argInfo.push_back(OptionInfo("battleRecord", &battleRecord, false));
+	_argInfo.push_back(OptionInfo("battleVerify", &battleVerify, ""));
 }
 
 // we can get fancier with these detection routines, but for now just look for
@@ -336,6 +343,10 @@ void resetDefault()
 	{
 		i->reset();
 	}
+	for (std::vector<OptionInfo>::iterator i = _argInfo.begin(); i != _argInfo.end(); ++i)
+	{
+		i->reset();
+	}
 	backupDisplay();
 
 	mods.clear();
@@ -891,6 +902,10 @@ void updateOptions()
 	{
 		i->load(_commandLine);
 	}
+	for (std::vector<OptionInfo>::iterator i = _argInfo.begin(); i != _argInfo.end(); ++i)
+	{
+		i->load(_commandLine);
+	}
 }
 
 /**
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <time.h>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include "Options.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+bool Profiler::_enabled = false;
+Uint64 Profiler::_frame[PROF_SECTIONS], Profiler::_lastFrame[PROF_SECTIONS], Profiler::_worstFrame[PROF_SECTIONS], Profiler::_turn[PROF_SECTIONS];
+unsigned int Profiler::_frameCalls[PROF_SECTIONS], Profiler::_turnCalls[PROF_SECTIONS];
+std::ofstream Profiler::_csv;
+
+/**
+ * Gets a timestamp in microseconds. SDL only
+ * counts milliseconds, too coarse for a line trace.
+ * @return Microseconds since some arbitrary point.
+ */
+Uint64 Profiler::now()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency;
+	if (frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (Uint64)(counter.QuadPart * 1000000 / frequency.QuadPart);
+#else
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return (Uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/**
+ * Adds a timing to a section's frame totals.
+ * @param section The section timed.
+ * @param time Time spent, in microseconds.
+ */
+void Profiler::add(Section section, Uint64 time)
+{
+	_frame[section] += time;
+	_frameCalls[section]++;
+}
+
+/**
+ * Turns profiling on or off for the rest of the battle, without
+ * touching the option. Totals start from zero when it's turned on.
+ * @param enabled Profile or not.
+ */
+void Profiler::setEnabled(bool enabled)
+{
+	if (enabled && !_enabled)
+	{
+		for (int i = 0; i < PROF_SECTIONS; ++i)
+		{
+			_frame[i] = _lastFrame[i] = _worstFrame[i] = _turn[i] = 0;
+			_frameCalls[i] = _turnCalls[i] = 0;
+		}
+	}
+	_enabled = enabled;
+}
+
+/**
+ * Gets the name of a section, as shown in the overlay and CSV.
+ * @param section The section.
+ * @return Section name.
+ */
+const char *Profiler::getName(Section section)
+{
+	static const char *names[PROF_SECTIONS] = { "FOV", "Line", "A*", "Reachable", "AI think", "Explode", "Lighting", "Terrain", "Actions", "End turn" };
+	return names[section];
+}
+
+/**
+ * Starts a new battle, profiling it if the option is on
+ * or the AI is playing it (for the per-turn log).
+ */
+void Profiler::startBattle()
+{
+	endBattle();
+	_enabled = false;
+	setEnabled(Options::battleProfiler || Options::battleAutoPlay);
+}
+
+/**
+ * Finishes the battle's CSV, if there is one.
+ */
+void Profiler::endBattle()
+{
+	if (_csv.is_open())
+	{
+		_csv.close();
+	}
+}
+
+/**
+ * Closes off the current frame, moving its totals into the turn's.
+ */
+void Profiler::endFrame()
+{
+	if (!_enabled)
+		return;
+	for (int i = 0; i < PROF_SECTIONS; ++i)
+	{
+		_lastFrame[i] = _frame[i];
+		_worstFrame[i] = std::max(_worstFrame[i], _frame[i]);
+		_turn[i] += _frame[i];
+		_turnCalls[i] += _frameCalls[i];
+		_frame[i] = 0;
+		_frameCalls[i] = 0;
+	}
+}
+
+/**
+ * Closes off the current turn and appends it to the battle's CSV,
+ * which is created in the user folder on the first turn profiled.
+ * @param turn Turn number.
+ * @param side Faction that just played.
+ */
+void Profiler::endTurn(int turn, int side)
+{
+	if (!_enabled)
+		return;
+	endFrame();
+	if (!_csv.is_open())
+	{
+		std::ostringstream ss;
+		ss << Options::getUserFolder() << "profile_" << time(0) << ".csv";
+		_csv.open(ss.str().c_str());
+		if (!_csv)
+		{
+			Log(LOG_WARNING) << "Failed to create " << ss.str();
+		}
+		_csv << "turn,side,section,calls,total_ms,worst_frame_ms" << std::endl;
+	}
+	for (int i = 0; i < PROF_SECTIONS; ++i)
+	{
+		_csv << turn << "," << side << "," << getName((Section)i) << "," << _turnCalls[i] << ","
+			<< _turn[i] / 1000.0 << "," << _worstFrame[i] / 1000.0 << "\n";
+		_turn[i] = _worstFrame[i] = 0;
+		_turnCalls[i] = 0;
+	}
+	_csv.flush();
+}
+
+/**
+ * Gets the time spent in a section in the turn so far,
+ * including the current frame.
+ * @param section The section.
+ * @return Time spent, in milliseconds.
+ */
+double Profiler::getTurnTime(Section section)
+{
+	return (_turn[section] + _frame[section]) / 1000.0;
+}
+
+/**
+ * Gets a summary of the time spent in each section,
+ * in the last frame and the turn so far. Times are inclusive,
+ * eg. FOV includes the lines it traces.
+ * @return One line per section.
+ */
+std::wstring Profiler::getSummary()
+{
+	std::wostringstream ss;
+	ss << std::fixed << std::setprecision(1);
+	for (int i = 0; i < PROF_SECTIONS; ++i)
+	{
+		const char *name = getName((Section)i);
+		ss << std::wstring(name, name + strlen(name)) << L": " << _lastFrame[i] / 1000.0 << L" ms, turn " << _turn[i] / 1000.0 << L" ms\n";
+	}
+	return ss.str();
+}
+
+}
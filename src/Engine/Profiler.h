@@ -0,0 +1,81 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <fstream>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Collects how much time the battlescape spends in its hot paths,
+ * per frame and per turn, for the debug overlay and a CSV per battle.
+ * Does nothing but check a flag while it's off.
+ */
+class Profiler
+{
+public:
+	/// The code paths being timed.
+	enum Section { PROF_FOV, PROF_LINE, PROF_PATHFINDING, PROF_REACHABLE, PROF_AI, PROF_EXPLODE, PROF_LIGHTING, PROF_DRAW_TERRAIN, PROF_STATES, PROF_END_TURN, PROF_SECTIONS };
+	/**
+	 * Adds the time spent in a scope to a section.
+	 */
+	class Scope
+	{
+	private:
+		Section _section;
+		Uint64 _start;
+	public:
+		/// Starts timing a section.
+		Scope(Section section) : _section(section), _start(_enabled ? now() : 0) { }
+		/// Stops timing the section.
+		~Scope() { if (_start) add(_section, now() - _start); }
+	};
+private:
+	static bool _enabled;
+	static Uint64 _frame[PROF_SECTIONS], _lastFrame[PROF_SECTIONS], _worstFrame[PROF_SECTIONS], _turn[PROF_SECTIONS];
+	static unsigned int _frameCalls[PROF_SECTIONS], _turnCalls[PROF_SECTIONS];
+	static std::ofstream _csv;
+public:
+	/// Gets a timestamp in microseconds.
+	static Uint64 now();
+	/// Adds a timing to a section.
+	static void add(Section section, Uint64 time);
+	/// Gets whether profiling is on.
+	static bool isEnabled() { return _enabled; }
+	/// Turns profiling on or off.
+	static void setEnabled(bool enabled);
+	/// Gets the name of a section.
+	static const char *getName(Section section);
+	/// Starts profiling a new battle.
+	static void startBattle();
+	/// Finishes the battle's CSV.
+	static void endBattle();
+	/// Closes off the current frame.
+	static void endFrame();
+	/// Closes off the current turn and writes it to the CSV.
+	static void endTurn(int turn, int side);
+	/// Gets the time spent in a section so far this turn.
+	static double getTurnTime(Section section);
+	/// Gets a summary of the last frame and the current turn.
+	static std::wstring getSummary();
+};
+
+}
@@ -499,3 +499,100 @@ void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_
 	}
 }
 
+/**
+ * Get the size of the intermediate buffer needed by ::scale_slice().
+ * \param scale Scale factor. 2, 3 or 4.
+ * \param pixel Bytes per pixel of the source and destination bitmap.
+ * \param width Horizontal size in pixels of the source bitmap.
+ * \param y_first First source row of the slice.
+ * \param y_last Source row after the last one of the slice.
+ * \return Size in bytes, 0 if no buffer is needed.
+ */
+unsigned scale_slice_buf_size(unsigned scale, unsigned pixel, unsigned width, unsigned y_first, unsigned y_last)
+{
+	if ((scale != 4 && scale != 404) || y_first >= y_last)
+		return 0;
+	/* the slice rows plus one on each side, scaled 2x */
+	return 2 * (y_last - y_first + 2) * ((2 * pixel * width + 0x7) & ~0x7);
+}
+
+/**
+ * Apply the Scale effect on a horizontal slice of a bitmap.
+ * Only the destination rows of the source rows [y_first, y_last) are written,
+ * the source rows around the slice are read like the whole bitmap was scaled,
+ * so slices of the same bitmap can be scaled in parallel without seams.
+ * The intermediate buffer is provided by the caller, so it can be kept
+ * between frames; its size is given by ::scale_slice_buf_size().
+ * \param scale Scale factor. 2, 3 or 4.
+ * \param void_dst Pointer at the first pixel of the destination bitmap.
+ * \param dst_slice Size in bytes of a destination bitmap row.
+ * \param void_src Pointer at the first pixel of the source bitmap.
+ * \param src_slice Size in bytes of a source bitmap row.
+ * \param pixel Bytes per pixel of the source and destination bitmap.
+ * \param width Horizontal size in pixels of the source bitmap.
+ * \param height Vertical size in pixels of the source bitmap.
+ * \param y_first First source row of the slice.
+ * \param y_last Source row after the last one of the slice.
+ * \param void_mid Pointer at the intermediate buffer, only used by Scale4x.
+ */
+void scale_slice(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, unsigned y_first, unsigned y_last, void* void_mid)
+{
+	unsigned char* dst = (unsigned char*)void_dst;
+	const unsigned char* src = (const unsigned char*)void_src;
+	unsigned y;
+
+	if (y_last > height)
+		y_last = height;
+
+	switch (scale) {
+	case 202 :
+	case 2 :
+		for (y = y_first; y < y_last; ++y) {
+			const unsigned char* above = SCSRC(y > 0 ? y - 1 : 0);
+			const unsigned char* below = SCSRC(y + 1 < height ? y + 1 : y);
+			stage_scale2x(SCDST(2 * y), SCDST(2 * y + 1), above, SCSRC(y), below, pixel, width);
+		}
+		break;
+	case 303 :
+	case 3 :
+		for (y = y_first; y < y_last; ++y) {
+			const unsigned char* above = SCSRC(y > 0 ? y - 1 : 0);
+			const unsigned char* below = SCSRC(y + 1 < height ? y + 1 : y);
+			stage_scale3x(SCDST(3 * y), SCDST(3 * y + 1), SCDST(3 * y + 2), above, SCSRC(y), below, pixel, width);
+		}
+		break;
+	case 404 :
+	case 4 : {
+		/* scale the source rows around the slice once, then scale those again */
+		unsigned mid_first = y_first > 0 ? y_first - 1 : 0;
+		unsigned mid_last = y_last + 1 < height ? y_last + 1 : height;
+		unsigned mid_slice = (2 * pixel * width + 0x7) & ~0x7;
+		unsigned char* mid = (unsigned char*)void_mid;
+		unsigned mid_max = 2 * height - 1;
+
+		if (y_first >= y_last || !mid)
+			break;
+
+		for (y = mid_first; y < mid_last; ++y) {
+			const unsigned char* above = SCSRC(y > 0 ? y - 1 : 0);
+			const unsigned char* below = SCSRC(y + 1 < height ? y + 1 : y);
+			unsigned char* row = mid + 2 * (y - mid_first) * mid_slice;
+			stage_scale2x(row, row + mid_slice, above, SCSRC(y), below, pixel, width);
+		}
+
+#define SCMIDROW(m) (mid + ((m) - 2 * mid_first) * mid_slice)
+		for (y = y_first; y < y_last; ++y) {
+			unsigned m0 = 2 * y > 0 ? 2 * y - 1 : 0;
+			unsigned m3 = 2 * y + 2 < mid_max ? 2 * y + 2 : mid_max;
+			stage_scale4x(SCDST(4 * y), SCDST(4 * y + 1), SCDST(4 * y + 2), SCDST(4 * y + 3), SCMIDROW(m0), SCMIDROW(2 * y), SCMIDROW(2 * y + 1), SCMIDROW(m3), pixel, width);
+		}
+#undef SCMIDROW
+
+		break;
+	}
+	}
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	scale2x_mmx_emms();
+#endif
+}
@@ -40,6 +40,26 @@ namespace OpenXcom
 const int Screen::ORIGINAL_WIDTH = 320;
 const int Screen::ORIGINAL_HEIGHT = 200;
 
+/**
+ * The screen's buffer. Notes down where each surface gets
+ * blit onto it, so the screen only redraws the areas that
+ * changed.
+ */
+class Screen::Buffer : public Surface
+{
+public:
+	/// Surfaces blit onto the buffer since the last flip.
+	std::vector<Blit> blits;
+	/// Creates a new buffer.
+	Buffer(int width, int height, int bpp) : Surface(width, height, 0, 0, bpp) {}
+	/// Notes an area of the buffer that got blit onto.
+	void damage(const Surface *source, const SDL_Rect &area, bool changed)
+	{
+		Blit blit = {source, area, changed};
+		blits.push_back(blit);
+	}
+};
+
 /**
  * Sets up all the internal display flags depending on
  * the current video settings.
@@ -104,7 +124,7 @@ void Screen::makeVideoFlags()
  * Initializes a new display screen for the game to render contents to.
  * The screen is set up based on the current options.
  */
-Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0)
+Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0), _redrawAll(true)
 {
 	resetDisplay();
 	memset(deferredPalette, 0, 256*sizeof(SDL_Color));
@@ -116,6 +136,7 @@ Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _sc
  */
 Screen::~Screen()
 {
+	Zoom::shutdown();
 	delete _surface;
 }
 
@@ -171,22 +192,121 @@ void Screen::handle(Action *action)
 }
 
 
+/**
+ * Works out which areas of the buffer changed since the last flip,
+ * from the surfaces blit onto it: the ones that changed, and the
+ * ones that moved, showed up or went away (their old and new areas).
+ * @param damage Returns the changed areas.
+ * @return True if the whole buffer needs redrawing instead,
+ * eg. after a palette change or if it was drawn onto directly.
+ */
+bool Screen::findDamage(std::vector<SDL_Rect> &damage)
+{
+	SDL_Surface *s = _surface->getSurface();
+	bool all = _surface->blits.empty();
+	if (s->format->palette != 0)
+	{
+		SDL_Palette *palette = s->format->palette;
+		if ((int)_lastPalette.size() != palette->ncolors || memcmp(&_lastPalette[0], palette->colors, palette->ncolors * sizeof(SDL_Color)) != 0)
+		{
+			_lastPalette.assign(palette->colors, palette->colors + palette->ncolors);
+			all = true;
+		}
+	}
+
+	const std::vector<Blit> &blits = _surface->blits;
+	for (size_t i = 0; !all && i < std::max(blits.size(), _lastBlits.size()); ++i)
+	{
+		bool same = i < blits.size() && i < _lastBlits.size() && blits[i].source == _lastBlits[i].source &&
+			blits[i].area.x == _lastBlits[i].area.x && blits[i].area.y == _lastBlits[i].area.y &&
+			blits[i].area.w == _lastBlits[i].area.w && blits[i].area.h == _lastBlits[i].area.h;
+		if (i < blits.size() && (!same || blits[i].changed))
+		{
+			damage.push_back(blits[i].area);
+		}
+		if (i < _lastBlits.size() && !same)
+		{
+			damage.push_back(_lastBlits[i].area);
+		}
+	}
+	_lastBlits.swap(_surface->blits);
+	_surface->blits.clear();
+
+	// keep the areas inside the buffer
+	for (std::vector<SDL_Rect>::iterator i = damage.begin(); i != damage.end();)
+	{
+		int x1 = std::max(0, (int)i->x), y1 = std::max(0, (int)i->y);
+		int x2 = std::min(s->w, i->x + i->w), y2 = std::min(s->h, i->y + i->h);
+		if (x1 >= x2 || y1 >= y2)
+		{
+			i = damage.erase(i);
+			continue;
+		}
+		i->x = x1;
+		i->y = y1;
+		i->w = x2 - x1;
+		i->h = y2 - y1;
+		++i;
+	}
+	return all;
+}
+
 /**
  * Renders the buffer's contents onto the screen, applying
  * any necessary filters or conversions in the process.
  * If the scaling factor is bigger than 1, the entire contents
  * of the buffer are resized by that factor (eg. 2 = doubled)
  * before being put on screen.
+ * On single-buffered software displays only the areas that
+ * changed since the last flip are scaled and updated.
  */
 void Screen::flip()
 {
-	if (getWidth() != _baseWidth || getHeight() != _baseHeight || useOpenGL())
+	std::vector<SDL_Rect> damage;
+	bool all = findDamage(damage);
+	bool partial = !all && !_redrawAll && !useOpenGL() && (_screen->flags & (SDL_HWSURFACE | SDL_DOUBLEBUF)) == 0;
+
+	// the rows to rescale, with two rows of margin since the scalers blend in their neighbours
+	std::vector<std::pair<int, int> > bands;
+	if (partial)
 	{
-		Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput);
+		for (std::vector<SDL_Rect>::const_iterator i = damage.begin(); i != damage.end(); ++i)
+		{
+			bands.push_back(std::make_pair(std::max(0, i->y - 2), std::min(_baseHeight, i->y + i->h + 2)));
+		}
+		std::sort(bands.begin(), bands.end());
+		size_t merged = 0;
+		for (size_t i = 1; i < bands.size(); ++i)
+		{
+			if (bands[i].first <= bands[merged].second)
+			{
+				bands[merged].second = std::max(bands[merged].second, bands[i].second);
+			}
+			else
+			{
+				bands[++merged] = bands[i];
+			}
+		}
+		bands.resize(std::min(bands.size(), merged + 1));
 	}
 	else
 	{
-		SDL_BlitSurface(_surface->getSurface(), 0, _screen, 0);
+		bands.push_back(std::make_pair(0, _baseHeight));
+		SDL_FillRect(_screen, &_clear, 0);
+	}
+
+	for (std::vector<std::pair<int, int> >::const_iterator i = bands.begin(); i != bands.end(); ++i)
+	{
+		if (getWidth() != _baseWidth || getHeight() != _baseHeight || useOpenGL())
+		{
+			Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput, i->first, i->second);
+		}
+		else
+		{
+			SDL_Rect srcrect = {0, (Sint16)i->first, (Uint16)_baseWidth, (Uint16)(i->second - i->first)};
+			SDL_Rect dstrect = srcrect;
+			SDL_BlitSurface(_surface->getSurface(), &srcrect, _screen, &dstrect);
+		}
 	}
 
 	// perform any requested palette update
@@ -201,10 +321,35 @@ void Screen::flip()
 	}
 
 
-	
-	if (SDL_Flip(_screen) == -1)
+	if (partial)
 	{
-		throw Exception(SDL_GetError());
+		if (!damage.empty())
+		{
+			// map the changed areas onto the display, with the scaler margin and a pixel of slack for rounding
+			int leftBand = std::max(0, _leftBlackBand), topBand = std::max(0, _topBlackBand);
+			int innerWidth = getWidth() - leftBand - std::max(0, _rightBlackBand);
+			int innerHeight = getHeight() - topBand - std::max(0, _bottomBlackBand);
+			for (std::vector<SDL_Rect>::iterator i = damage.begin(); i != damage.end(); ++i)
+			{
+				int x1 = std::max(0, leftBand + (i->x - 2) * innerWidth / _baseWidth - 1);
+				int x2 = std::min(getWidth(), leftBand + ((i->x + i->w + 2) * innerWidth + _baseWidth - 1) / _baseWidth + 1);
+				int y1 = std::max(0, topBand + (i->y - 2) * innerHeight / _baseHeight - 1);
+				int y2 = std::min(getHeight(), topBand + ((i->y + i->h + 2) * innerHeight + _baseHeight - 1) / _baseHeight + 1);
+				i->x = x1;
+				i->y = y1;
+				i->w = x2 - x1;
+				i->h = y2 - y1;
+			}
+			SDL_UpdateRects(_screen, damage.size(), &damage[0]);
+		}
+	}
+	else
+	{
+		_redrawAll = false;
+		if (SDL_Flip(_screen) == -1)
+		{
+			throw Exception(SDL_GetError());
+		}
 	}
 }
 
@@ -214,8 +359,15 @@ void Screen::flip()
 void Screen::clear()
 {
 	_surface->clear();
-	if (_screen->flags & SDL_SWSURFACE) memset(_screen->pixels, 0, _screen->h*_screen->pitch);
-	else SDL_FillRect(_screen, &_clear, 0);
+}
+
+/**
+ * Forces the next flip to clear the display and redraw all
+ * of it, eg. after the window contents were lost.
+ */
+void Screen::invalidate()
+{
+	_redrawAll = true;
 }
 
 /**
@@ -313,7 +465,7 @@ void Screen::resetDisplay(bool resetVideo)
 		_surface->getSurface()->h != _baseHeight)) // don't reallocate _surface if not necessary, it's a waste of CPU cycles
 	{
 		if (_surface) delete _surface;
-		_surface = new Surface(_baseWidth, _baseHeight, 0, 0, Screen::use32bitScaler() ? 32 : 8); // only HQX/XBRZ needs 32bpp for this surface; the OpenGL class has its own 32bpp buffer
+		_surface = new Buffer(_baseWidth, _baseHeight, Screen::use32bitScaler() ? 32 : 8); // only HQX/XBRZ needs 32bpp for this surface; the OpenGL class has its own 32bpp buffer
 		if (_surface->getSurface()->format->BitsPerPixel == 8) _surface->setPalette(deferredPalette);
 	}
 	SDL_SetColorKey(_surface->getSurface(), 0, 0); // turn off color key! 
@@ -367,6 +519,7 @@ void Screen::resetDisplay(bool resetVideo)
 	_clear.y = 0;
 	_clear.w = getWidth();
 	_clear.h = getHeight();
+	_redrawAll = true;
 
 	double pixelRatioY = 1.0;
 	if (Options::nonSquarePixelRatio && !Options::allowResize)
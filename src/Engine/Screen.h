@@ -19,6 +19,7 @@
  */
 #include <SDL.h>
 #include <string>
+#include <vector>
 #include "OpenGL.h"
 
 namespace OpenXcom
@@ -38,6 +39,14 @@ class Action;
 class Screen
 {
 private:
+	class Buffer;
+	/// A surface blit onto the buffer.
+	struct Blit
+	{
+		const Surface *source;
+		SDL_Rect area;
+		bool changed;
+	};
 	SDL_Surface *_screen;
 	int _bpp;
 	int _baseWidth, _baseHeight;
@@ -48,10 +57,15 @@ private:
 	int _numColors, _firstColor;
 	bool _pushPalette;
 	OpenGL glOutput;
-	Surface *_surface;
+	Buffer *_surface;
 	SDL_Rect _clear;
+	std::vector<Blit> _lastBlits;
+	std::vector<SDL_Color> _lastPalette;
+	bool _redrawAll;
 	/// Sets the _flags and _bpp variables based on game options; needed in more than one place now
 	void makeVideoFlags();
+	/// Finds the buffer areas changed since the last flip.
+	bool findDamage(std::vector<SDL_Rect> &damage);
 public:
 	static const int ORIGINAL_WIDTH;
 	static const int ORIGINAL_HEIGHT;
@@ -72,6 +86,8 @@ public:
 	void flip();
 	/// Clears the screen.
 	void clear();
+	/// Forces the whole screen to be redrawn on the next flip.
+	void invalidate();
 	/// Sets the screen's 8bpp palette.
 	void setPalette(SDL_Color *colors, int firstcolor = 0, int ncolors = 256, bool immediately = false);
 	/// Gets the screen's 8bpp palette.
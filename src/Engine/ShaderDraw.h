@@ -21,19 +21,44 @@
 	
 namespace OpenXcom
 {
+namespace helper
+{
 
 /**
- * Universal blit function
- * @tparam ColorFunc class that contains static function `func` that get 5 arguments
- * function is used to modify these arguments.
- * @param dest_frame destination surface modified by function.
- * @param src0_frame surface or scalar
- * @param src1_frame surface or scalar
- * @param src2_frame surface or scalar
- * @param src3_frame surface or scalar
+ * Inner loop of `ShaderDraw`, calls `ColorFunc::func` for every pixel of a row.
  */
-template<typename ColorFunc, typename DestType, typename Src0Type, typename Src1Type, typename Src2Type, typename Src3Type>
-static inline void ShaderDraw(const DestType& dest_frame, const Src0Type& src0_frame, const Src1Type& src1_frame, const Src2Type& src2_frame, const Src3Type& src3_frame)
+template<typename ColorFunc>
+struct PixelLoop
+{
+	template<typename Dest, typename Src0, typename Src1, typename Src2, typename Src3>
+	static inline void run(Dest& dest, Src0& src0, Src1& src1, Src2& src2, Src3& src3, int size)
+	{
+		for (int x = size; x>0; --x, dest.inc_x(), src0.inc_x(), src1.inc_x(), src2.inc_x(), src3.inc_x())
+		{
+			ColorFunc::func(dest.get_ref(), src0.get_ref(), src1.get_ref(), src2.get_ref(), src3.get_ref());
+		}
+	}
+};
+
+/**
+ * Inner loop of `ShaderDrawRow`, calls `RowFunc::row` once for the whole row.
+ */
+template<typename RowFunc>
+struct RowLoop
+{
+	template<typename Dest, typename Src0, typename Src1, typename Src2, typename Src3>
+	static inline void run(Dest& dest, Src0& src0, Src1& src1, Src2& src2, Src3& src3, int size)
+	{
+		RowFunc::row(&dest.get_ref(), &src0.get_ref(), &src1.get_ref(), &src2.get_ref(), &src3.get_ref(), size);
+	}
+};
+
+/**
+ * Iterates over the common range of all arguments and
+ * hands every row to `Loop::run`.
+ */
+template<typename Loop, typename DestType, typename Src0Type, typename Src1Type, typename Src2Type, typename Src3Type>
+static inline void ShaderDrawLoop(const DestType& dest_frame, const Src0Type& src0_frame, const Src1Type& src1_frame, const Src2Type& src2_frame, const Src3Type& src3_frame)
 {
 	//creating helper objects
 	helper::controler<DestType> dest(dest_frame);
@@ -98,14 +123,31 @@ static inline void ShaderDraw(const DestType& dest_frame, const Src0Type& src0_f
 		src3.set_x(begin_x, end_x);
 		
 		//iteration on x-axis
-		for (int x = end_x-begin_x; x>0; --x, dest.inc_x(), src0.inc_x(), src1.inc_x(), src2.inc_x(), src3.inc_x())
-		{
-			ColorFunc::func(dest.get_ref(), src0.get_ref(), src1.get_ref(), src2.get_ref(), src3.get_ref());
-		}
+		Loop::run(dest, src0, src1, src2, src3, end_x-begin_x);
 	}
 
+	//only the destination got drawn on
+	dest_frame.setChanged();
 }
-	
+
+}//namespace helper
+
+/**
+ * Universal blit function
+ * @tparam ColorFunc class that contains static function `func` that get 5 arguments
+ * function is used to modify these arguments.
+ * @param dest_frame destination surface modified by function.
+ * @param src0_frame surface or scalar
+ * @param src1_frame surface or scalar
+ * @param src2_frame surface or scalar
+ * @param src3_frame surface or scalar
+ */
+template<typename ColorFunc, typename DestType, typename Src0Type, typename Src1Type, typename Src2Type, typename Src3Type>
+static inline void ShaderDraw(const DestType& dest_frame, const Src0Type& src0_frame, const Src1Type& src1_frame, const Src2Type& src2_frame, const Src3Type& src3_frame)
+{
+	helper::ShaderDrawLoop<helper::PixelLoop<ColorFunc> >(dest_frame, src0_frame, src1_frame, src2_frame, src3_frame);
+}
+
 template<typename ColorFunc, typename DestType, typename Src0Type, typename Src1Type, typename Src2Type>
 static inline void ShaderDraw(const DestType& dest_frame, const Src0Type& src0_frame, const Src1Type& src1_frame, const Src2Type& src2_frame)
 {
@@ -127,6 +169,40 @@ static inline void ShaderDraw(const DestType& dest_frame)
 	ShaderDraw<ColorFunc>(dest_frame, helper::Nothing(), helper::Nothing(), helper::Nothing(), helper::Nothing());
 }
 
+/**
+ * Row blit function, same as `ShaderDraw` but calls `RowFunc::row` once per row
+ * with pointers to the first pixel of every argument and the number of pixels.
+ * Only usable with surfaces whose pixels are contiguous in a row (not `ShaderRepeat`),
+ * scalars and unused arguments give a pointer to their single value.
+ * Intended for functions that process several pixels at once, e.g. with SIMD.
+ * @tparam RowFunc class that contains static function `row` that get 6 arguments
+ * @param dest_frame destination surface modified by function.
+ * @param src0_frame surface or scalar
+ * @param src1_frame surface or scalar
+ * @param src2_frame surface or scalar
+ * @param src3_frame surface or scalar
+ */
+template<typename RowFunc, typename DestType, typename Src0Type, typename Src1Type, typename Src2Type, typename Src3Type>
+static inline void ShaderDrawRow(const DestType& dest_frame, const Src0Type& src0_frame, const Src1Type& src1_frame, const Src2Type& src2_frame, const Src3Type& src3_frame)
+{
+	helper::ShaderDrawLoop<helper::RowLoop<RowFunc> >(dest_frame, src0_frame, src1_frame, src2_frame, src3_frame);
+}
+template<typename RowFunc, typename DestType, typename Src0Type, typename Src1Type, typename Src2Type>
+static inline void ShaderDrawRow(const DestType& dest_frame, const Src0Type& src0_frame, const Src1Type& src1_frame, const Src2Type& src2_frame)
+{
+	ShaderDrawRow<RowFunc>(dest_frame, src0_frame, src1_frame, src2_frame, helper::Nothing());
+}
+template<typename RowFunc, typename DestType, typename Src0Type, typename Src1Type>
+static inline void ShaderDrawRow(const DestType& dest_frame, const Src0Type& src0_frame, const Src1Type& src1_frame)
+{
+	ShaderDrawRow<RowFunc>(dest_frame, src0_frame, src1_frame, helper::Nothing(), helper::Nothing());
+}
+template<typename RowFunc, typename DestType, typename Src0Type>
+static inline void ShaderDrawRow(const DestType& dest_frame, const Src0Type& src0_frame)
+{
+	ShaderDrawRow<RowFunc>(dest_frame, src0_frame, helper::Nothing(), helper::Nothing(), helper::Nothing());
+}
+
 template<typename T>
 static inline helper::Scalar<T> ShaderScalar(T& t)
 {
@@ -125,6 +125,12 @@ public:
 	{
 		return _range_domain;
 	}
+
+	/// Nothing to tell, a vector doesn't keep track of changes.
+	inline void setChanged() const
+	{
+
+	}
 };
 
 /**
@@ -231,6 +237,7 @@ protected:
 	const GraphSubset _range_base;
 	GraphSubset _range_domain;
 	const int _pitch;
+	Surface* const _surface;
 	
 public:
 	///copy constructor
@@ -238,7 +245,8 @@ public:
 		_orgin(s.ptr()),
 		_range_base(s.getBaseDomain()),
 		_range_domain(s.getDomain()),
-		_pitch(s.pitch())		
+		_pitch(s.pitch()),
+		_surface(s._surface)
 	{
 			
 	}
@@ -254,9 +262,10 @@ public:
 		_orgin((Uint8*) s->getSurface()->pixels),
 		_range_base(s->getWidth(), s->getHeight()),
 		_range_domain(s->getWidth(), s->getHeight()),
-		_pitch(s->getSurface()->pitch)		
+		_pitch(s->getSurface()->pitch),
+		_surface(s)
 	{
-			
+		
 	}
 	
 	/**
@@ -273,7 +282,8 @@ public:
 		_orgin(&(f[0])),
 		_range_base(max_x, max_y),
 		_range_domain(max_x, max_y),
-		_pitch(max_x)	
+		_pitch(max_x),
+		_surface(0)
 	{
 		
 	}
@@ -304,6 +314,16 @@ public:
 	{
 		return _range_domain;
 	}
+
+	/// Marks the surface as changed, once something was drawn onto it.
+	inline void setChanged() const
+	{
+		if (_surface)
+		{
+			_surface->setDirty();
+			_surface->invalidateSpans();
+		}
+	}
 };
 
 /**
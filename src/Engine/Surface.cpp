@@ -37,6 +37,17 @@
 #define _aligned_free   __mingw_aligned_free
 #endif //MINGW
 #include "Language.h"
+#include "Zoom.h"
+#include "CrossPlatform.h"
+#if (_MSC_VER >= 1400) || (defined(__MINGW32__) && defined(__SSE2__))
+#ifndef __SSE2__
+#define __SSE2__ true
+#endif
+#include <intrin.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #ifdef __MORPHOS__
 #include <ppcinline/exec.h>
 #endif
@@ -121,6 +132,120 @@ inline void DeleteAligned(void* buffer)
 	}
 }
 
+/**
+ * Shading results for every palette index, indexed by
+ * [new color group + 1, or 0 to keep the source group][shade][source index].
+ * Shades past 15 turn everything black, so they all share the last row.
+ */
+Uint8 shadeTable[17][17][256];
+bool shadeTableBuilt = false;
+
+/**
+ * Gets the lookup table that applies a shade and an optional new
+ * color group to a palette index, same as StandardShade or ColorReplace.
+ * It only depends on palette layout (16 groups of 16 shades), not on the
+ * colors themselves, so it's shared by every palette.
+ * @param shade Shade offset, clamped to 0-16.
+ * @param newColor Color block to replace with, or -1 to keep it.
+ * @return 256 entry lookup table.
+ */
+const Uint8 *getShadeTable(int shade, int newColor)
+{
+	if (!shadeTableBuilt)
+	{
+		for (int group = 0; group < 17; ++group)
+		{
+			for (int s = 0; s < 17; ++s)
+			{
+				for (int src = 0; src < 256; ++src)
+				{
+					const int newShade = (src&15) + s;
+					if (newShade > 15)
+						// so dark it would flip over to another color - make it black instead
+						shadeTable[group][s][src] = 15;
+					else
+						shadeTable[group][s][src] = (group == 0 ? (src&(15<<4)) : (group - 1) << 4) | newShade;
+				}
+			}
+		}
+		shadeTableBuilt = true;
+	}
+	int group = newColor == -1 ? 0 : ((newColor >> 4) & 15) + 1;
+	return shadeTable[group][std::max(0, std::min(shade, 16))];
+}
+
+/**
+ * Blits span-encoded pixels (see Surface::setSpans) onto a surface,
+ * applying the same shading as StandardShade or ColorReplace.
+ * @param spans Span list.
+ * @param pixels Packed span pixels.
+ * @param height Number of rows in the span list.
+ * @param dest Surface to blit to.
+ * @param x X position on the destination.
+ * @param y Y position on the destination.
+ * @param fromX Leftmost source column to draw.
+ * @param shade Shade offset.
+ * @param newColor Color block to replace with, or -1 to keep it.
+ */
+void blitSpans(const Uint16 *spans, const Uint8 *pixels, int height, SDL_Surface *dest, int x, int y, int fromX, int shade, int newColor)
+{
+	const SDL_Rect &clip = dest->clip_rect;
+	const int minX = std::max(fromX, clip.x - x);
+	const int maxX = clip.x + clip.w - x;
+	const int minY = clip.y - y;
+	const int maxY = std::min(height, clip.y + clip.h - y);
+	const Uint8 *table = (shade == 0 && newColor == -1) ? 0 : getShadeTable(shade, newColor);
+	for (int row = 0; row < maxY; ++row)
+	{
+		const int count = *spans++;
+		if (row < minY || minX >= maxX)
+		{
+			for (int i = 0; i < count; ++i, spans += 2)
+			{
+				pixels += spans[1];
+			}
+			continue;
+		}
+		Uint8 *out = (Uint8*)dest->pixels + (y + row) * dest->pitch + x;
+		for (int i = 0; i < count; ++i, spans += 2)
+		{
+			const int begin = spans[0];
+			const int end = begin + spans[1];
+			const Uint8 *in = pixels;
+			pixels += spans[1];
+			const int b = std::max(begin, minX);
+			const int e = std::min(end, maxX);
+			if (table == 0)
+			{
+				if (b < e)
+					memcpy(out + b, in + (b - begin), e - b);
+				continue;
+			}
+			for (int j = b; j < e; ++j)
+			{
+				out[j] = table[in[j - begin]];
+			}
+		}
+	}
+}
+
+/**
+ * Checks if two surfaces share the same palette, so blitting
+ * from one to the other needs no color mapping.
+ * @param a First surface.
+ * @param b Second surface.
+ * @return True if the palettes match.
+ */
+bool samePalette(SDL_Surface *a, SDL_Surface *b)
+{
+	SDL_Palette *pa = a->format->palette, *pb = b->format->palette;
+	if (pa == pb)
+		return true;
+	if (pa == 0 || pb == 0 || pa->ncolors != pb->ncolors)
+		return false;
+	return memcmp(pa->colors, pb->colors, pa->ncolors * sizeof(SDL_Color)) == 0;
+}
+
 } //namespace
 
 /**
@@ -135,7 +260,7 @@ inline void DeleteAligned(void* buffer)
  * @param y Y position in pixels.
  * @param bpp Bits-per-pixel depth.
  */
-Surface::Surface(int width, int height, int x, int y, int bpp) : _x(x), _y(y), _visible(true), _hidden(false), _redraw(false), _tftdMode(false), _alignedBuffer(0)
+Surface::Surface(int width, int height, int x, int y, int bpp) : _x(x), _y(y), _visible(true), _hidden(false), _redraw(false), _tftdMode(false), _dirty(true), _alignedBuffer(0), _spans(0), _spanPixels(0)
 {
 	_alignedBuffer = NewAligned(bpp, width, height);
 	_surface = SDL_CreateRGBSurfaceFrom(_alignedBuffer, width, height, bpp, GetPitch(bpp, width), 0, 0, 0, 0);
@@ -161,7 +286,7 @@ Surface::Surface(int width, int height, int x, int y, int bpp) : _x(x), _y(y), _
  * Performs a deep copy of an existing surface.
  * @param other Surface to copy from.
  */
-Surface::Surface(const Surface& other)
+Surface::Surface(const Surface& other) : _spans(0), _spanPixels(0)
 {
 	//if is native OpenXcom aligned surface
 	if (other._alignedBuffer)
@@ -200,6 +325,8 @@ Surface::Surface(const Surface& other)
 	_visible = other._visible;
 	_hidden = other._hidden;
 	_redraw = other._redraw;
+	_tftdMode = other._tftdMode;
+	_dirty = true;
 }
 
 /**
@@ -220,23 +347,23 @@ Surface::~Surface()
  */
 void Surface::loadScr(const std::string &filename)
 {
+	_dirty = true;
+	invalidateSpans();
 	// Load file and put pixels in surface
-	std::ifstream imgFile(filename.c_str(), std::ios::binary);
-	if (!imgFile)
+	std::vector<Uint8> buffer;
+	if (!CrossPlatform::readFile(filename, buffer))
 	{
 		throw Exception(filename + " not found");
 	}
 
-	std::vector<char> buffer((std::istreambuf_iterator<char>(imgFile)), (std::istreambuf_iterator<char>()));
-
 	// Lock the surface
 	lock();
 
 	int x = 0, y = 0;
 
-	for (std::vector<char>::iterator i = buffer.begin(); i != buffer.end(); ++i)
+	if (!buffer.empty())
 	{
-		setPixelIterative(&x, &y, *i);
+		setPixelRun(&x, &y, &buffer[0], (int)buffer.size());
 	}
 
 	// Unlock the surface
@@ -250,6 +377,8 @@ void Surface::loadScr(const std::string &filename)
  */
 void Surface::loadImage(const std::string &filename)
 {
+	_dirty = true;
+	invalidateSpans();
 	// Destroy current surface (will be replaced)
 	DeleteAligned(_alignedBuffer);
 	SDL_FreeSurface(_surface);
@@ -325,9 +454,11 @@ void Surface::loadImage(const std::string &filename)
  */
 void Surface::loadSpk(const std::string &filename)
 {
+	_dirty = true;
+	invalidateSpans();
 	// Load file and put pixels in surface
-	std::ifstream imgFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::vector<Uint8> buffer;
+	if (!CrossPlatform::readFile(filename, buffer))
 	{
 		throw Exception(filename + " not found");
 	}
@@ -335,41 +466,34 @@ void Surface::loadSpk(const std::string &filename)
 	// Lock the surface
 	lock();
 
-	Uint16 flag;
-	Uint8 value;
 	int x = 0, y = 0;
+	size_t i = 0;
 
-	while (imgFile.read((char*)&flag, sizeof(flag)))
+	while (i + 4 <= buffer.size())
 	{
-		flag = SDL_SwapLE16(flag);
+		Uint16 flag = buffer[i] | (buffer[i + 1] << 8);
+		Uint16 count = buffer[i + 2] | (buffer[i + 3] << 8);
 
 		if (flag == 65535)
 		{
-			imgFile.read((char*)&flag, sizeof(flag));
-			flag = SDL_SwapLE16(flag);
-
-			for (int i = 0; i < flag * 2; ++i)
-			{
-				setPixelIterative(&x, &y, 0);
-			}
+			fillPixelRun(&x, &y, 0, count * 2);
+			i += 4;
 		}
 		else if (flag == 65534)
 		{
-			imgFile.read((char*)&flag, sizeof(flag));
-			flag = SDL_SwapLE16(flag);
-
-			for (int i = 0; i < flag * 2; ++i)
-			{
-				imgFile.read((char*)&value, 1);
-				setPixelIterative(&x, &y, value);
-			}
+			i += 4;
+			int run = (int)std::min((size_t)count * 2, buffer.size() - i);
+			setPixelRun(&x, &y, &buffer[0] + i, run);
+			i += count * 2;
+		}
+		else
+		{
+			i += 2;
 		}
 	}
 
 	// Unlock the surface
 	unlock();
-
-	imgFile.close();
 }
 
 /**
@@ -381,9 +505,11 @@ void Surface::loadSpk(const std::string &filename)
  */
 void Surface::loadBdy(const std::string &filename)
 {
+	_dirty = true;
+	invalidateSpans();
 	// Load file and put pixels in surface
-	std::ifstream imgFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::vector<Uint8> buffer;
+	if (!CrossPlatform::readFile(filename, buffer))
 	{
 		throw Exception(filename + " not found");
 	}
@@ -391,43 +517,106 @@ void Surface::loadBdy(const std::string &filename)
 	// Lock the surface
 	lock();
 
-	Uint8 dataByte;
-	int pixelCnt;
 	int x = 0, y = 0;
-	int currentRow = 0;
+	size_t i = 0;
 
-	while (imgFile.read((char*)&dataByte, sizeof(dataByte)))
+	while (i < buffer.size())
 	{
+		Uint8 dataByte = buffer[i++];
 		if (dataByte >= 129)
 		{
-			pixelCnt = 257 - (int)dataByte;
-			imgFile.read((char*)&dataByte, sizeof(dataByte));
-			currentRow = y;
-			for (int i = 0; i < pixelCnt; ++i)
-			{
-				if (currentRow == y) // avoid overscan into next row
-					setPixelIterative(&x, &y, dataByte);
-			}
+			int pixelCnt = 257 - (int)dataByte;
+			if (i >= buffer.size())
+				break;
+			// avoid overscan into next row
+			fillPixelRun(&x, &y, buffer[i++], std::min(pixelCnt, getWidth() - x));
 		}
 		else
 		{
-			pixelCnt = 1 + (int)dataByte;
-			currentRow = y;
-			for (int i = 0; i < pixelCnt; ++i)
-			{
-				imgFile.read((char*)&dataByte, sizeof(dataByte));
-				if (currentRow == y) // avoid overscan into next row
-					setPixelIterative(&x, &y, dataByte);
-			}
+			int pixelCnt = 1 + (int)dataByte;
+			int run = (int)std::min((size_t)pixelCnt, buffer.size() - i);
+			// avoid overscan into next row
+			setPixelRun(&x, &y, &buffer[0] + i, std::min(run, getWidth() - x));
+			i += pixelCnt;
 		}
 	}
 
 	// Unlock the surface
 	unlock();
+}
+
 
-	imgFile.close();
+/**
+ * Changes the color of a run of pixels in the surface, wrapping over
+ * rows the same as repeated calls to setPixelIterative would, but
+ * copying whole row segments at once.
+ * @param x Pointer to the X position of the first pixel. Changed to the next X position in the sequence.
+ * @param y Pointer to the Y position of the first pixel. Changed to the next Y position in the sequence.
+ * @param pixels New colors for the pixels.
+ * @param count Number of pixels.
+ */
+void Surface::setPixelRun(int *x, int *y, const Uint8 *pixels, int count)
+{
+	_dirty = true;
+	invalidateSpans();
+	if (_surface->format->BytesPerPixel != 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			setPixelIterative(x, y, pixels[i]);
+		}
+		return;
+	}
+	const int width = getWidth();
+	while (count > 0 && *y < getHeight())
+	{
+		int len = std::min(count, width - *x);
+		memcpy((Uint8*)_surface->pixels + *y * _surface->pitch + *x, pixels, len);
+		pixels += len;
+		count -= len;
+		*x += len;
+		if (*x == width)
+		{
+			(*y)++;
+			*x = 0;
+		}
+	}
 }
 
+/**
+ * Fills a run of pixels in the surface with the same color,
+ * wrapping over rows like setPixelRun.
+ * @param x Pointer to the X position of the first pixel. Changed to the next X position in the sequence.
+ * @param y Pointer to the Y position of the first pixel. Changed to the next Y position in the sequence.
+ * @param pixel New color for the pixels.
+ * @param count Number of pixels.
+ */
+void Surface::fillPixelRun(int *x, int *y, Uint8 pixel, int count)
+{
+	_dirty = true;
+	invalidateSpans();
+	if (_surface->format->BytesPerPixel != 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			setPixelIterative(x, y, pixel);
+		}
+		return;
+	}
+	const int width = getWidth();
+	while (count > 0 && *y < getHeight())
+	{
+		int len = std::min(count, width - *x);
+		memset((Uint8*)_surface->pixels + *y * _surface->pitch + *x, pixel, len);
+		count -= len;
+		*x += len;
+		if (*x == width)
+		{
+			(*y)++;
+			*x = 0;
+		}
+	}
+}
 
 /**
  * Clears the entire contents of the surface, resulting
@@ -436,6 +625,8 @@ void Surface::loadBdy(const std::string &filename)
  */
 void Surface::clear(Uint32 color)
 {
+	_dirty = true;
+	invalidateSpans();
 	if (_surface->flags & SDL_SWSURFACE) memset(_surface->pixels, color, _surface->h*_surface->pitch);
 	else SDL_FillRect(_surface, &_clear, color);
 }
@@ -451,6 +642,8 @@ void Surface::clear(Uint32 color)
  */
 void Surface::offset(int off, int min, int max, int mul)
 {
+	_dirty = true;
+	invalidateSpans();
 	if (off == 0)
 		return;
 
@@ -501,6 +694,8 @@ void Surface::offset(int off, int min, int max, int mul)
  */
 void Surface::offsetBlock(int off, int blk, int mul)
 {
+	_dirty = true;
+	invalidateSpans();
 	if (off == 0)
 		return;
 
@@ -551,6 +746,8 @@ void Surface::offsetBlock(int off, int blk, int mul)
  */
 void Surface::invert(Uint8 mid)
 {
+	_dirty = true;
+	invalidateSpans();
 	// Lock the surface
 	lock();
 
@@ -604,7 +801,10 @@ void Surface::blit(Surface *surface)
 	if (_visible && !_hidden)
 	{
 		if (_redraw)
+		{
+			_dirty = true;
 			draw();
+		}
 
 		SDL_Rect* cropper;
 		SDL_Rect target;
@@ -618,10 +818,31 @@ void Surface::blit(Surface *surface)
 		}
 		target.x = getX();
 		target.y = getY();
+		SDL_Rect area = {target.x, target.y, cropper ? cropper->w : (Uint16)getWidth(), cropper ? cropper->h : (Uint16)getHeight()};
+		surface->damage(this, area, _dirty);
+		_dirty = false;
+		if (_spans && cropper == 0 && surface->getSurface()->format->BitsPerPixel == 8 && samePalette(_surface, surface->getSurface()))
+		{
+			blitSpans(_spans, _spanPixels, getHeight(), surface->getSurface(), target.x, target.y, 0, 0, -1);
+			return;
+		}
 		SDL_BlitSurface(_surface, cropper, surface->getSurface(), &target);
 	}
 }
 
+/**
+ * Notes that another surface was blit onto this one,
+ * which changes this surface's pixels.
+ * @param source Surface that was blit.
+ * @param area Area that was blit onto.
+ * @param changed Whether the blit surface changed since it was last blit.
+ */
+void Surface::damage(const Surface *, const SDL_Rect &, bool)
+{
+	_dirty = true;
+	invalidateSpans();
+}
+
 /**
  * Copies the exact contents of another surface onto this one.
  * Only the content that would overlap both surfaces is copied, in
@@ -665,6 +886,8 @@ void Surface::copy(Surface *surface)
  */
 void Surface::drawRect(SDL_Rect *rect, Uint8 color)
 {
+	_dirty = true;
+	invalidateSpans();
 	SDL_FillRect(_surface, rect, color);
 }
 
@@ -678,6 +901,8 @@ void Surface::drawRect(SDL_Rect *rect, Uint8 color)
  */
 void Surface::drawRect(Sint16 x, Sint16 y, Sint16 w, Sint16 h, Uint8 color)
 {
+	_dirty = true;
+	invalidateSpans();
 	SDL_Rect rect;
 	rect.w = w;
 	rect.h = h;
@@ -696,6 +921,8 @@ void Surface::drawRect(Sint16 x, Sint16 y, Sint16 w, Sint16 h, Uint8 color)
  */
 void Surface::drawLine(Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, Uint8 color)
 {
+	_dirty = true;
+	invalidateSpans();
 	lineColor(_surface, x1, y1, x2, y2, Palette::getRGBA(getPalette(), color));
 }
 
@@ -708,6 +935,8 @@ void Surface::drawLine(Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, Uint8 color)
  */
 void Surface::drawCircle(Sint16 x, Sint16 y, Sint16 r, Uint8 color)
 {
+	_dirty = true;
+	invalidateSpans();
 	filledCircleColor(_surface, x, y, r, Palette::getRGBA(getPalette(), color));
 }
 
@@ -720,6 +949,8 @@ void Surface::drawCircle(Sint16 x, Sint16 y, Sint16 r, Uint8 color)
  */
 void Surface::drawPolygon(Sint16 *x, Sint16 *y, int n, Uint8 color)
 {
+	_dirty = true;
+	invalidateSpans();
 	filledPolygonColor(_surface, x, y, n, Palette::getRGBA(getPalette(), color));
 }
 
@@ -734,6 +965,8 @@ void Surface::drawPolygon(Sint16 *x, Sint16 *y, int n, Uint8 color)
  */
 void Surface::drawTexturedPolygon(Sint16 *x, Sint16 *y, int n, Surface *texture, int dx, int dy)
 {
+	_dirty = true;
+	invalidateSpans();
 	texturedPolygon(_surface, x, y, n, texture->getSurface(), dx, dy);
 }
 
@@ -746,6 +979,8 @@ void Surface::drawTexturedPolygon(Sint16 *x, Sint16 *y, int n, Surface *texture,
  */
 void Surface::drawString(Sint16 x, Sint16 y, const char *s, Uint8 color)
 {
+	_dirty = true;
+	invalidateSpans();
 	stringColor(_surface, x, y, s, Palette::getRGBA(getPalette(), color));
 }
 
@@ -796,14 +1031,18 @@ void Surface::resetCrop()
 	_crop.h = 0;
 	_crop.x = 0;
 	_crop.y = 0;
+	_dirty = true;
 }
 
 /**
  * Returns the cropping rectangle for this surface.
+ * Since it can be changed through the pointer, the
+ * surface counts as changed.
  * @return Pointer to the cropping rectangle.
  */
 SDL_Rect *Surface::getCrop()
 {
+	_dirty = true;
 	return &_crop;
 }
 
@@ -815,6 +1054,7 @@ SDL_Rect *Surface::getCrop()
  */
 void Surface::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 {
+	_dirty = true;
 	if (_surface->format->BitsPerPixel == 8)
 		SDL_SetColors(_surface, colors, firstcolor, ncolors);
 }
@@ -839,6 +1079,9 @@ void Surface::setHidden(bool hidden)
  */
 void Surface::lock()
 {
+	_dirty = true;
+	// the pixels may change, so the span encoding can't be trusted anymore
+	invalidateSpans();
 	SDL_LockSurface(_surface);
 }
 
@@ -909,7 +1152,133 @@ struct StandardShade
 
 };
 
+/**
+ * help class used for Surface::blitNShade
+ */
+struct ShadeLookup
+{
+	/**
+	* Function used by ShaderDraw in Surface::blitNShade
+	* set shade and color through a lookup table from getShadeTable
+	* @param dest destination pixel
+	* @param src source pixel
+	* @param table lookup table for the shade and color
+	* @param notused
+	* @param notused
+	*/
+	static inline void func(Uint8& dest, const Uint8& src, const Uint8 *const& table, const int&, const int&)
+	{
+		if (src)
+		{
+			dest = table[src];
+		}
+	}
+
+};
 
+#ifdef __SSE2__
+
+/**
+ * Shades 16 pixels at once, same as StandardShade (or ColorReplace
+ * when `replace` is set) but without branching.
+ * @param dest destination pixels
+ * @param src source pixels
+ * @param shade shade broadcast to 16bit lanes
+ * @param newColor new color broadcast to 16bit lanes
+ * @param replace use newColor instead of the color group of the source
+ */
+static inline void shadeBlockSSE2(Uint8 *dest, const Uint8 *src, __m128i shade, __m128i newColor, bool replace)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i shadeMask = _mm_set1_epi16(15);
+	const __m128i groupMask = _mm_set1_epi16(15<<4);
+	const __m128i byteMask = _mm_set1_epi16(0xFF);
+
+	__m128i s = _mm_loadu_si128((const __m128i*)src);
+	__m128i d = _mm_loadu_si128((const __m128i*)dest);
+	__m128i half[2] = { _mm_unpacklo_epi8(s, zero), _mm_unpackhi_epi8(s, zero) };
+	for (int i = 0; i < 2; ++i)
+	{
+		__m128i newShade = _mm_add_epi16(_mm_and_si128(half[i], shadeMask), shade);
+		__m128i group = replace ? newColor : _mm_and_si128(half[i], groupMask);
+		__m128i color = _mm_and_si128(_mm_or_si128(group, newShade), byteMask);
+		// so dark it would flip over to another color - make it black instead
+		__m128i black = _mm_cmpgt_epi16(newShade, shadeMask);
+		half[i] = _mm_or_si128(_mm_andnot_si128(black, color), _mm_and_si128(black, shadeMask));
+	}
+	__m128i transparent = _mm_cmpeq_epi8(s, zero);
+	__m128i result = _mm_packus_epi16(half[0], half[1]);
+	_mm_storeu_si128((__m128i*)dest, _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, result)));
+}
+
+/**
+ * help class used for Surface::blitNShade with SSE2
+ */
+struct ColorReplaceSSE2
+{
+	/**
+	* Function used by ShaderDrawRow in Surface::blitNShade
+	* set shade and replace color in a row of that surface
+	*/
+	static inline void row(Uint8 *dest, const Uint8 *src, const int *shade, const int *newColor, const int *, int size)
+	{
+		const __m128i shade16 = _mm_set1_epi16(*shade);
+		const __m128i color16 = _mm_set1_epi16(*newColor);
+		int x = 0;
+		for (; x + 16 <= size; x += 16)
+		{
+			shadeBlockSSE2(dest + x, src + x, shade16, color16, true);
+		}
+		for (; x < size; ++x)
+		{
+			ColorReplace::func(dest[x], src[x], *shade, *newColor, 0);
+		}
+	}
+};
+
+/**
+ * help class used for Surface::blitNShade with SSE2
+ */
+struct StandardShadeSSE2
+{
+	/**
+	* Function used by ShaderDrawRow in Surface::blitNShade
+	* set shade in a row of that surface
+	*/
+	static inline void row(Uint8 *dest, const Uint8 *src, const int *shade, const int *, const int *, int size)
+	{
+		const __m128i shade16 = _mm_set1_epi16(*shade);
+		int x = 0;
+		for (; x + 16 <= size; x += 16)
+		{
+			shadeBlockSSE2(dest + x, src + x, shade16, shade16, false);
+		}
+		for (; x < size; ++x)
+		{
+			StandardShade::func(dest[x], src[x], *shade, 0, 0);
+		}
+	}
+};
+
+#endif
+
+
+
+/**
+ * Sets the opaque span encoding of this surface, built by the
+ * SurfaceSet that owns it. Every row is stored as a count of spans
+ * followed by an (x, length) pair for each run of non-transparent
+ * pixels, and the pixels of all spans are packed in order.
+ * The encoding is dropped as soon as the pixels change, see invalidateSpans.
+ * @param spans Span list, or 0 to remove it.
+ * @param pixels Packed span pixels.
+ */
+void Surface::setSpans(const Uint16 *spans, const Uint8 *pixels)
+{
+	_dirty = true;
+	_spans = spans;
+	_spanPixels = pixels;
+}
 
 /**
  * Specific blit function to blit battlescape terrain data in different shades in a fast way.
@@ -924,6 +1293,16 @@ struct StandardShade
  */
 void Surface::blitNShade(Surface *surface, int x, int y, int off, bool half, int newBaseColor)
 {
+	if (_spans && surface->getSurface()->format->BitsPerPixel == 8)
+	{
+		// same as StandardShade/ColorReplace, but only visits the opaque pixels
+		int fromX = half ? getWidth() / 2 : 0;
+		int newColor = newBaseColor ? (newBaseColor - 1) << 4 : -1;
+		blitSpans(_spans, _spanPixels, getHeight(), surface->getSurface(), x - surface->getX(), y - surface->getY(), fromX, off, newColor);
+		surface->setDirty();
+		surface->invalidateSpans();
+		return;
+	}
 	ShaderMove<Uint8> src(this, x, y);
 	if (half)
 	{
@@ -931,15 +1310,22 @@ void Surface::blitNShade(Surface *surface, int x, int y, int off, bool half, int
 		g.beg_x = g.end_x/2;
 		src.setDomain(g);
 	}
-	if (newBaseColor)
+#ifdef __SSE2__
+	if (Zoom::haveSSE2())
 	{
-		--newBaseColor;
-		newBaseColor <<= 4;
-		ShaderDraw<ColorReplace>(ShaderSurface(surface), src, ShaderScalar(off), ShaderScalar(newBaseColor));
+		if (newBaseColor)
+		{
+			--newBaseColor;
+			newBaseColor <<= 4;
+			ShaderDrawRow<ColorReplaceSSE2>(ShaderSurface(surface), src, ShaderScalar(off), ShaderScalar(newBaseColor));
+		}
+		else
+			ShaderDrawRow<StandardShadeSSE2>(ShaderSurface(surface), src, ShaderScalar(off));
+		return;
 	}
-	else
-		ShaderDraw<StandardShade>(ShaderSurface(surface), src, ShaderScalar(off));
-
+#endif
+	const Uint8 *table = getShadeTable(off, newBaseColor ? (newBaseColor - 1) << 4 : -1);
+	ShaderDraw<ShadeLookup>(ShaderSurface(surface), src, ShaderScalar(table));
 }
 
 /**
@@ -980,6 +1366,8 @@ void Surface::setTooltip(const std::string &tooltip)
  */
 void Surface::resize(int width, int height)
 {
+	_dirty = true;
+	invalidateSpans();
 	// Set up new surface
 	Uint8 bpp = _surface->format->BitsPerPixel;
 	int pitch = GetPitch(bpp, width);
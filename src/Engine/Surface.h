@@ -39,8 +39,10 @@ protected:
 	SDL_Surface *_surface;
 	int _x, _y;
 	SDL_Rect _crop, _clear;
-	bool _visible, _hidden, _redraw, _tftdMode;
+	bool _visible, _hidden, _redraw, _tftdMode, _dirty;
 	void *_alignedBuffer;
+	const Uint16 *_spans;
+	const Uint8 *_spanPixels;
 	std::string _tooltip;
 
 	void resize(int width, int height);
@@ -73,6 +75,25 @@ public:
 	virtual void draw();
 	/// Blits this surface onto another one.
 	virtual void blit(Surface *surface);
+	/// Notes an area of the surface that got blit onto.
+	virtual void damage(const Surface *source, const SDL_Rect &area, bool changed);
+	/**
+	 * Marks the surface's pixels as changed since it was
+	 * last blit, for pixel writes the surface can't see.
+	 */
+	void setDirty()
+	{
+		_dirty = true;
+	}
+	/**
+	 * Drops the span encoding of the surface, which
+	 * no longer matches once the pixels change.
+	 */
+	void invalidateSpans()
+	{
+		_spans = 0;
+		_spanPixels = 0;
+	}
 	/// Initializes the surface's various text resources.
 	virtual void initText(Font *, Font *, Language *) {};
 	/// Copies a portion of another surface into this one.
@@ -143,6 +164,8 @@ public:
 			return;
 		}
 		((Uint8 *)_surface->pixels)[y * _surface->pitch + x * _surface->format->BytesPerPixel] = pixel;
+		_dirty = true;
+		invalidateSpans();
 	}
 	/**
 	 * Changes the color of a pixel in the surface and returns the
@@ -162,6 +185,10 @@ public:
 			*x = 0;
 		}
 	}
+	/// Changes the color of a run of pixels and returns the next pixel position.
+	void setPixelRun(int *x, int *y, const Uint8 *pixels, int count);
+	/// Fills a run of pixels with a color and returns the next pixel position.
+	void fillPixelRun(int *x, int *y, Uint8 pixel, int count);
 	/**
 	 * Returns the color of a specified pixel in the surface.
 	 * @param x X position of the pixel.
@@ -212,6 +239,8 @@ public:
 	void unlock();
 	/// Specific blit function to blit battlescape terrain data in different shades in a fast way.
 	void blitNShade(Surface *surface, int x, int y, int off, bool half = false, int newBaseColor = 0);
+	/// Sets the opaque span encoding of the surface.
+	void setSpans(const Uint16 *spans, const Uint8 *pixels);
 	/// Invalidate the surface: force it to be redrawn
 	void invalidate(bool valid = true);
 	/// Gets the tooltip of the surface.
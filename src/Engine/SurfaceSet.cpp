@@ -18,8 +18,11 @@
  */
 #include "SurfaceSet.h"
 #include <fstream>
+#include <algorithm>
+#include <SDL_thread.h>
 #include "Surface.h"
 #include "Exception.h"
+#include "CrossPlatform.h"
 
 namespace OpenXcom
 {
@@ -111,51 +114,138 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 	}
 
 	// Load PCK and put pixels in surfaces
-	std::ifstream imgFile (pck.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::vector<Uint8> data;
+	if (!CrossPlatform::readFile(pck, data))
 	{
 		throw Exception(pck + " not found");
 	}
 
-	Uint8 value;
-
-	for (int frame = 0; frame < nframes; ++frame)
+	size_t i = 0;
+	for (int frame = 0; frame < nframes && i < data.size(); ++frame)
 	{
 		int x = 0, y = 0;
+		Surface *surface = _frames[frame];
 
 		// Lock the surface
-		_frames[frame]->lock();
+		surface->lock();
 
-		imgFile.read((char*)&value, 1);
-		for (int i = 0; i < value; ++i)
-		{
-			for (int j = 0; j < _width; ++j)
-			{
-				_frames[frame]->setPixelIterative(&x, &y, 0);
-			}
-		}
+		surface->fillPixelRun(&x, &y, 0, data[i++] * _width);
 
-		while (imgFile.read((char*)&value, 1) && value != 255)
+		while (i < data.size() && data[i] != 255)
 		{
-			if (value == 254)
+			if (data[i] == 254)
 			{
-				imgFile.read((char*)&value, 1);
-				for (int i = 0; i < value; ++i)
+				if (i + 1 < data.size())
 				{
-					_frames[frame]->setPixelIterative(&x, &y, 0);
+					surface->fillPixelRun(&x, &y, 0, data[i + 1]);
 				}
+				i += 2;
 			}
 			else
 			{
-				_frames[frame]->setPixelIterative(&x, &y, value);
+				// copy the whole run of literal pixels at once
+				size_t end = i;
+				while (end < data.size() && data[end] < 254)
+				{
+					++end;
+				}
+				surface->setPixelRun(&x, &y, &data[i], (int)(end - i));
+				i = end;
 			}
 		}
+		++i;
 
 		// Unlock the surface
-		_frames[frame]->unlock();
+		surface->unlock();
 	}
+}
+
+namespace
+{
+
+/// Share of a batch of PCK sets decoded by one thread.
+struct PckBatch
+{
+	const std::vector<SurfaceSet*> *sets;
+	const std::vector<std::pair<std::string, std::string> > *files;
+	std::vector<std::string> *errors;
+	size_t first, step;
+};
+
+/**
+ * Decodes every n-th set of a batch, keeping any
+ * error to be rethrown on the calling thread.
+ * @param data Pointer to the PckBatch.
+ * @return Thread exit code.
+ */
+int loadPckBatch(void *data)
+{
+	PckBatch *batch = (PckBatch*)data;
+	for (size_t i = batch->first; i < batch->sets->size(); i += batch->step)
+	{
+		try
+		{
+			(*batch->sets)[i]->loadPck((*batch->files)[i].first, (*batch->files)[i].second);
+		}
+		catch (std::exception &e)
+		{
+			(*batch->errors)[i] = e.what();
+		}
+	}
+	return 0;
+}
 
-	imgFile.close();
+}
+
+/**
+ * Loads several sets of PCK/TAB files, decoding them in
+ * parallel on one thread per core since they're independent.
+ * @param sets Surface sets to load into.
+ * @param files PCK and TAB filenames for each set.
+ */
+void SurfaceSet::loadPcks(const std::vector<SurfaceSet*> &sets, const std::vector<std::pair<std::string, std::string> > &files)
+{
+	size_t threads = std::min(sets.size(), (size_t)CrossPlatform::getNumberOfCores());
+	std::vector<std::string> errors(sets.size());
+	std::vector<PckBatch> batches(threads);
+	for (size_t i = 0; i < threads; ++i)
+	{
+		batches[i].sets = &sets;
+		batches[i].files = &files;
+		batches[i].errors = &errors;
+		batches[i].first = i;
+		batches[i].step = threads;
+	}
+
+	std::vector<SDL_Thread*> workers;
+	for (size_t i = 1; i < threads; ++i)
+	{
+		SDL_Thread *thread = SDL_CreateThread(loadPckBatch, &batches[i]);
+		if (thread == 0)
+		{
+			loadPckBatch(&batches[i]);
+		}
+		else
+		{
+			workers.push_back(thread);
+		}
+	}
+	if (threads > 0)
+	{
+		loadPckBatch(&batches[0]);
+	}
+	for (std::vector<SDL_Thread*>::iterator i = workers.begin(); i != workers.end(); ++i)
+	{
+		SDL_WaitThread(*i, 0);
+	}
+
+	for (std::vector<std::string>::iterator i = errors.begin(); i != errors.end(); ++i)
+	{
+		if (!i->empty())
+		{
+			throw Exception(*i);
+		}
+	}
 }
 
 /**
@@ -171,51 +261,28 @@ void SurfaceSet::loadDat(const std::string &filename)
 	int nframes = 0;
 
 	// Load file and put pixels in surface
-	std::ifstream imgFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::vector<Uint8> data;
+	if (!CrossPlatform::readFile(filename, data))
 	{
 		throw Exception(filename + " not found");
 	}
 
-	imgFile.seekg(0, std::ios::end);
-	std::streamoff size = imgFile.tellg();
-	imgFile.seekg(0, std::ios::beg);
-
-	nframes = (int)size / (_width * _height);
+	const int frameSize = _width * _height;
+	nframes = (int)data.size() / frameSize;
 
 	for (int i = 0; i < nframes; ++i)
 	{
 		Surface *surface = new Surface(_width, _height);
 		_frames[i] = surface;
-	}
-
-	Uint8 value;
-	int x = 0, y = 0, frame = 0;
-
-	// Lock the surface
-	_frames[frame]->lock();
-
-	while (imgFile.read((char*)&value, 1))
-	{
-		_frames[frame]->setPixelIterative(&x, &y, value);
 
-		if (y >= _height)
-		{
-			// Unlock the surface
-			_frames[frame]->unlock();
-
-			frame++;
-			x = 0;
-			y = 0;
+		int x = 0, y = 0;
 
-			if (frame >= nframes)
-				break;
-			else
-				_frames[frame]->lock();
-		}
+		// Lock the surface
+		surface->lock();
+		surface->setPixelRun(&x, &y, &data[i * frameSize], frameSize);
+		// Unlock the surface
+		surface->unlock();
 	}
-
-	imgFile.close();
 }
 
 /**
@@ -290,4 +357,63 @@ std::map<int, Surface*> *SurfaceSet::getFrames()
 	return &_frames;
 }
 
+/**
+ * Packs the opaque pixels of all the frames into one contiguous
+ * buffer, along with a list of opaque spans for each row, and hands
+ * each frame its part so it can be blitted without testing every
+ * pixel for transparency. Should be called once the frames are
+ * final; any frame modified later falls back to the regular blitters.
+ */
+void SurfaceSet::buildAtlas()
+{
+	_spans.clear();
+	_atlas.clear();
+	std::vector<std::pair<size_t, size_t> > offsets;
+	for (std::map<int, Surface*>::iterator i = _frames.begin(); i != _frames.end(); ++i)
+	{
+		SDL_Surface *s = i->second->getSurface();
+		i->second->setSpans(0, 0);
+		if (s->format->BitsPerPixel != 8 || !(s->flags & SDL_SRCCOLORKEY) || s->format->colorkey != 0)
+		{
+			offsets.push_back(std::make_pair(std::string::npos, std::string::npos));
+			continue;
+		}
+		offsets.push_back(std::make_pair(_spans.size(), _atlas.size()));
+		for (int y = 0; y < s->h; ++y)
+		{
+			const Uint8 *row = (const Uint8*)s->pixels + y * s->pitch;
+			size_t count = _spans.size();
+			_spans.push_back(0);
+			for (int x = 0; x < s->w;)
+			{
+				if (row[x] == 0)
+				{
+					++x;
+					continue;
+				}
+				int begin = x;
+				while (x < s->w && row[x] != 0)
+				{
+					++x;
+				}
+				_spans.push_back(begin);
+				_spans.push_back(x - begin);
+				_atlas.insert(_atlas.end(), row + begin, row + x);
+				_spans[count]++;
+			}
+		}
+	}
+
+	// only hand out pointers once the buffers stopped growing
+	std::vector<std::pair<size_t, size_t> >::const_iterator offset = offsets.begin();
+	for (std::map<int, Surface*>::iterator i = _frames.begin(); i != _frames.end(); ++i, ++offset)
+	{
+		if (offset->first != std::string::npos)
+		{
+			const Uint8 *pixels = _atlas.empty() ? 0 : &_atlas[0] + offset->second;
+			i->second->setSpans(&_spans[offset->first], pixels);
+		}
+	}
+}
+
 }
@@ -19,6 +19,7 @@
  */
 #include <map>
 #include <string>
+#include <vector>
 #include <SDL.h>
 
 namespace OpenXcom
@@ -37,6 +38,8 @@ class SurfaceSet
 private:
 	int _width, _height;
 	std::map<int, Surface*> _frames;
+	std::vector<Uint16> _spans;
+	std::vector<Uint8> _atlas;
 public:
 	/// Crates a surface set with frames of the specified size.
 	SurfaceSet(int width, int height);
@@ -48,6 +51,8 @@ public:
 	void loadPck(const std::string &pck, const std::string &tab = "");
 	/// Loads an X-Com DAT image file.
 	void loadDat(const std::string &filename);
+	/// Loads several sets of PCK/TAB files at once.
+	static void loadPcks(const std::vector<SurfaceSet*> &sets, const std::vector<std::pair<std::string, std::string> > &files);
 	/// Gets a particular frame from the set.
 	Surface *getFrame(int i);
 	/// Creates a new surface and returns a pointer to it.
@@ -61,6 +66,8 @@ public:
 	/// Sets the surface set's palette.
 	void setPalette(SDL_Color *colors, int firstcolor = 0, int ncolors = 256);
 	std::map<int, Surface*> *getFrames();
+	/// Packs the frames into a transparency-skipping atlas.
+	void buildAtlas();
 };
 
 }
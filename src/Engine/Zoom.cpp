@@ -19,10 +19,14 @@
 
 #include "Zoom.h"
 
+#include <algorithm>
+#include <vector>
+#include <SDL_thread.h>
 #include "Surface.h"
 #include "Logger.h"
 #include "Options.h"
 #include "Screen.h"
+#include "CrossPlatform.h"
 
 #include "OpenGL.h"
 
@@ -630,7 +634,7 @@ static int zoomSurface2X_SSE2(SDL_Surface *src, SDL_Surface *dst)
  * Checks the SSE2 feature bit returned by the CPUID instruction
  * @return Does the CPU support SSE2?
  */
-bool Zoom::haveSSE2()
+static bool checkSSE2()
 {
 #ifdef __GNUC__
 	unsigned int CPUInfo[4] = {0, 0, 0, 0};
@@ -645,8 +649,326 @@ bool Zoom::haveSSE2()
 	return (CPUInfo[3] & 0x04000000) ? true : false;
 }
 
+/**
+ * Checks for SSE2 support, running CPUID only on the first call.
+ * @return Does the CPU support SSE2?
+ */
+bool Zoom::haveSSE2()
+{
+	static const bool sse2 = checkSSE2();
+	return sse2;
+}
+
 #endif
 
+namespace
+{
+
+/// Upscalers that can be split into horizontal bands.
+enum BandScaler { BAND_XBRZ, BAND_HQX, BAND_SCALEX };
+
+/// A frame's worth of upscaling shared by all band workers.
+struct BandJob
+{
+	BandScaler scaler;
+	int factor;
+	SDL_Surface *src, *dst;
+	int yFirst, yLast;
+	int bands;
+};
+
+/// Scratch memory kept by one band between frames.
+struct BandScratch
+{
+	std::vector<Uint8> buffer;
+	int w, h;
+	BandScratch() : w(0), h(0) {}
+};
+
+const int MAX_BANDS = 16;
+
+BandJob _bandJob;
+BandScratch _bandScratch[MAX_BANDS];
+std::vector<SDL_Thread*> _bandThreads;
+std::vector<SDL_sem*> _bandStart;
+SDL_sem *_bandDone = 0;
+volatile bool _bandQuit = false;
+
+SDL_Surface *_letterbox = 0;
+bool _letterboxIsView = false;
+Uint32 _paletteLut[256];
+
+/**
+ * Gets the scratch memory of a band, big enough for the given size.
+ * The memory is only reallocated when the source surface changes size
+ * or the band grows past anything seen before, so steady frames reuse it.
+ * Each band is only ever run by one thread, so no locking is needed.
+ * @param band Band index.
+ * @param src Source surface.
+ * @param size Size in bytes needed.
+ * @return Pointer to the scratch memory, 0 if none is needed.
+ */
+void *getBandScratch(int band, SDL_Surface *src, size_t size)
+{
+	BandScratch &scratch = _bandScratch[band];
+	if (scratch.w != src->w || scratch.h != src->h)
+	{
+		std::vector<Uint8>().swap(scratch.buffer);
+		scratch.w = src->w;
+		scratch.h = src->h;
+	}
+	if (scratch.buffer.size() < size)
+	{
+		scratch.buffer.resize(size);
+	}
+	return scratch.buffer.empty() ? 0 : &scratch.buffer[0];
+}
+
+/**
+ * Upscales one horizontal band of the source surface. Every scaler
+ * reads the neighbouring source rows across the band edges straight
+ * from the shared source, so the bands stitch together seamlessly.
+ * @param job Frame to upscale.
+ * @param band Band index.
+ */
+void runBand(const BandJob &job, int band)
+{
+	SDL_Surface *src = job.src, *dst = job.dst;
+	int rows = job.yLast - job.yFirst;
+	int yFirst = job.yFirst + rows * band / job.bands;
+	int yLast = job.yFirst + rows * (band + 1) / job.bands;
+	if (yFirst >= yLast)
+		return;
+	switch (job.scaler)
+	{
+	case BAND_XBRZ:
+		xbrz::scale(job.factor, (uint32_t*)src->pixels, (uint32_t*)dst->pixels, src->w, src->h, xbrz::RGB, xbrz::ScalerCfg(), yFirst, yLast);
+		break;
+	case BAND_HQX:
+		if (job.factor == 2)
+			hq2x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, yFirst, yLast);
+		else if (job.factor == 3)
+			hq3x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, yFirst, yLast);
+		else
+			hq4x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, yFirst, yLast);
+		break;
+	case BAND_SCALEX:
+	{
+		size_t size = scale_slice_buf_size(job.factor, src->format->BytesPerPixel, src->w, yFirst, yLast);
+		void *mid = getBandScratch(band, src, size);
+		scale_slice(job.factor, dst->pixels, dst->pitch, src->pixels, src->pitch, src->format->BytesPerPixel, src->w, src->h, yFirst, yLast, mid);
+		break;
+	}
+	}
+}
+
+/**
+ * Body of a persistent band worker: sleeps until a frame
+ * is posted, upscales its band and reports back.
+ * @param data Band index handled by this worker.
+ * @return Thread exit code.
+ */
+int bandWorker(void *data)
+{
+	int band = (int)(size_t)data;
+	while (true)
+	{
+		SDL_SemWait(_bandStart[band - 1]);
+		if (_bandQuit)
+			break;
+		runBand(_bandJob, band);
+		SDL_SemPost(_bandDone);
+	}
+	return 0;
+}
+
+/**
+ * Stops the band worker threads, if any are running.
+ */
+void stopBandWorkers()
+{
+	_bandQuit = true;
+	for (size_t i = 0; i < _bandThreads.size(); ++i)
+	{
+		SDL_SemPost(_bandStart[i]);
+	}
+	for (std::vector<SDL_Thread*>::iterator i = _bandThreads.begin(); i != _bandThreads.end(); ++i)
+	{
+		SDL_WaitThread(*i, 0);
+	}
+	_bandThreads.clear();
+	for (std::vector<SDL_sem*>::iterator i = _bandStart.begin(); i != _bandStart.end(); ++i)
+	{
+		SDL_DestroySemaphore(*i);
+	}
+	_bandStart.clear();
+	if (_bandDone)
+	{
+		SDL_DestroySemaphore(_bandDone);
+		_bandDone = 0;
+	}
+	_bandQuit = false;
+}
+
+/**
+ * Gets how many bands the upscaler should be split into,
+ * restarting the worker pool if the setting changed.
+ * @return Number of bands (1 means no workers).
+ */
+int getBandCount()
+{
+	int bands = Options::scalerThreads > 0 ? Options::scalerThreads : CrossPlatform::getNumberOfCores();
+	bands = std::max(1, std::min(bands, MAX_BANDS));
+	if ((int)_bandThreads.size() != bands - 1)
+	{
+		stopBandWorkers();
+		_bandDone = SDL_CreateSemaphore(0);
+		_bandStart.resize(bands - 1, 0);
+		for (int i = 0; i < bands - 1; ++i)
+		{
+			_bandStart[i] = SDL_CreateSemaphore(0);
+		}
+		for (int i = 0; i < bands - 1; ++i)
+		{
+			SDL_Thread *thread = SDL_CreateThread(bandWorker, (void*)(size_t)(i + 1));
+			if (thread == 0)
+			{
+				Log(LOG_WARNING) << "Failed to start scaler thread: " << SDL_GetError();
+				break;
+			}
+			_bandThreads.push_back(thread);
+		}
+		bands = (int)_bandThreads.size() + 1;
+		if (Options::verboseLogging)
+		{
+			Log(LOG_INFO) << "Upscaling with " << bands << " thread(s).";
+		}
+	}
+	return (int)_bandThreads.size() + 1;
+}
+
+/**
+ * Upscales a frame, splitting it into horizontal bands
+ * across the worker pool when more than one thread is set.
+ * The calling thread always handles the first band.
+ * @param scaler Upscaler to use.
+ * @param factor Scaling factor.
+ * @param src The surface to zoom (input).
+ * @param dst The zoomed surface (output).
+ * @param yFirst First source row to upscale.
+ * @param yLast Source row past the last one to upscale.
+ */
+void scaleInBands(BandScaler scaler, int factor, SDL_Surface *src, SDL_Surface *dst, int yFirst, int yLast)
+{
+	// tiny bands would mostly redo the overlap rows
+	int bands = std::min(getBandCount(), std::max(1, (yLast - yFirst) / 16));
+	_bandJob.scaler = scaler;
+	_bandJob.factor = factor;
+	_bandJob.src = src;
+	_bandJob.dst = dst;
+	_bandJob.yFirst = yFirst;
+	_bandJob.yLast = yLast;
+	_bandJob.bands = bands;
+	for (int i = 1; i < bands; ++i)
+	{
+		SDL_SemPost(_bandStart[i - 1]);
+	}
+	runBand(_bandJob, 0);
+	for (int i = 1; i < bands; ++i)
+	{
+		SDL_SemWait(_bandDone);
+	}
+}
+
+/**
+ * Gets the surface the zoomed image goes into when the screen is
+ * letterboxed. Normally this is a view straight into the inner
+ * rectangle of the screen, but xBRZ needs a tightly packed target
+ * and locked surfaces can move their pixels, so those get a
+ * separate buffer instead. Either one is kept between frames and
+ * only recreated when the screen or the black bands change.
+ * @param dst The screen surface.
+ * @param x Left edge of the inner rectangle.
+ * @param y Top edge of the inner rectangle.
+ * @param w Width of the inner rectangle.
+ * @param h Height of the inner rectangle.
+ * @return Letterbox surface.
+ */
+SDL_Surface *getLetterbox(SDL_Surface *dst, int x, int y, int w, int h)
+{
+	SDL_PixelFormat *fmt = dst->format;
+	bool packed = (Screen::use32bitScaler() && Options::useXBRZFilter) || SDL_MUSTLOCK(dst);
+	Uint8 *pixels = (Uint8*)dst->pixels + y * dst->pitch + x * fmt->BytesPerPixel;
+	if (_letterbox != 0)
+	{
+		bool same = _letterbox->w == w && _letterbox->h == h && _letterboxIsView == !packed &&
+			_letterbox->format->BitsPerPixel == fmt->BitsPerPixel &&
+			_letterbox->format->Rmask == fmt->Rmask && _letterbox->format->Gmask == fmt->Gmask && _letterbox->format->Bmask == fmt->Bmask;
+		if (same && !packed)
+		{
+			same = _letterbox->pixels == pixels && _letterbox->pitch == dst->pitch;
+		}
+		if (same)
+		{
+			return _letterbox;
+		}
+		SDL_FreeSurface(_letterbox);
+		_letterbox = 0;
+	}
+	if (packed)
+	{
+		_letterbox = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	}
+	else
+	{
+		_letterbox = SDL_CreateRGBSurfaceFrom(pixels, w, h, fmt->BitsPerPixel, dst->pitch, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	}
+	_letterboxIsView = !packed;
+	return _letterbox;
+}
+
+/**
+ * Expands an 8-bit paletted surface straight into a 32-bit
+ * pixel buffer, skipping SDL's generic blitter.
+ * @param src The paletted surface.
+ * @param dst The 32-bit surface.
+ */
+void expandPalette(SDL_Surface *src, SDL_Surface *dst)
+{
+	SDL_Palette *palette = src->format->palette;
+	for (int i = 0; i < palette->ncolors && i < 256; ++i)
+	{
+		_paletteLut[i] = SDL_MapRGB(dst->format, palette->colors[i].r, palette->colors[i].g, palette->colors[i].b);
+	}
+	int w = std::min(src->w, dst->w);
+	int h = std::min(src->h, dst->h);
+	for (int y = 0; y < h; ++y)
+	{
+		const Uint8 *in = (const Uint8*)src->pixels + y * src->pitch;
+		Uint32 *out = (Uint32*)((Uint8*)dst->pixels + y * dst->pitch);
+		for (int x = 0; x < w; ++x)
+		{
+			out[x] = _paletteLut[in[x]];
+		}
+	}
+}
+
+}
+
+/**
+ * Stops the upscaler worker threads and frees
+ * the buffers kept between frames.
+ */
+void Zoom::shutdown()
+{
+	stopBandWorkers();
+	if (_letterbox != 0)
+	{
+		SDL_FreeSurface(_letterbox);
+		_letterbox = 0;
+	}
+}
+
 /**
  * Wrapper around various software and OpenGL screen buffer pushing functions which zoom.
  * Basically called just from Screen::flip()
@@ -658,8 +980,10 @@ bool Zoom::haveSSE2()
  * @param leftBlackBand Size of left black band in pixels (letterboxing).
  * @param rightBlackBand Size of right black band in pixels (letterboxing).
  * @param glOut OpenGL output.
+ * @param yFirst First source row that changed since the last flip.
+ * @param yLast Source row past the last one that changed.
  */
-void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, int bottomBlackBand, int leftBlackBand, int rightBlackBand, OpenGL *glOut)
+void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, int bottomBlackBand, int leftBlackBand, int rightBlackBand, OpenGL *glOut, int yFirst, int yLast)
 {
 	int dstWidth = dst->w - leftBlackBand - rightBlackBand;
 	int dstHeight = dst->h - topBlackBand - bottomBlackBand;
@@ -668,7 +992,15 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 #ifndef __NO_OPENGL
 		if (glOut->buffer_surface)
 		{
-			SDL_BlitSurface(src, 0, glOut->buffer_surface->getSurface(), 0); // TODO; this is less than ideal...
+			SDL_Surface *buffer = glOut->buffer_surface->getSurface();
+			if (src->format->BitsPerPixel == 8 && src->format->palette != 0 && buffer->format->BitsPerPixel == 32)
+			{
+				expandPalette(src, buffer);
+			}
+			else
+			{
+				SDL_BlitSurface(src, 0, buffer, 0);
+			}
 
 			glOut->refresh(glOut->linear, glOut->iwidth, glOut->iheight, dst->w, dst->h, topBlackBand, bottomBlackBand, leftBlackBand, rightBlackBand);
 			SDL_GL_SwapBuffers();
@@ -677,24 +1009,29 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 	}
 	else if (topBlackBand <= 0 && bottomBlackBand <= 0 && leftBlackBand <= 0 && rightBlackBand <= 0)
 	{
-		_zoomSurfaceY(src, dst, 0, 0);
+		_zoomSurfaceY(src, dst, 0, 0, yFirst, yLast);
 	}
 	else if (dstWidth == src->w && dstHeight == src->h)
 	{
-		SDL_Rect dstrect = {(Sint16)leftBlackBand, (Sint16)topBlackBand, (Uint16)src->w, (Uint16)src->h};
-		SDL_BlitSurface(src, NULL, dst, &dstrect);
+		yFirst = std::max(yFirst, 0);
+		yLast = std::min(yLast, src->h);
+		SDL_Rect srcrect = {0, (Sint16)yFirst, (Uint16)src->w, (Uint16)(yLast - yFirst)};
+		SDL_Rect dstrect = {(Sint16)leftBlackBand, (Sint16)(topBlackBand + yFirst), (Uint16)src->w, (Uint16)(yLast - yFirst)};
+		SDL_BlitSurface(src, &srcrect, dst, &dstrect);
 	}
 	else
 	{
-		SDL_Surface *tmp = SDL_CreateRGBSurface(dst->flags, dstWidth, dstHeight, dst->format->BitsPerPixel, 0, 0, 0, 0);
-		_zoomSurfaceY(src, tmp, 0, 0);
-		if (src->format->palette != NULL)
+		SDL_Surface *letterbox = getLetterbox(dst, leftBlackBand, topBlackBand, dstWidth, dstHeight);
+		_zoomSurfaceY(src, letterbox, 0, 0, yFirst, yLast);
+		if (!_letterboxIsView)
 		{
-			SDL_SetPalette(tmp, SDL_LOGPAL|SDL_PHYSPAL, src->format->palette->colors, 0, src->format->palette->ncolors);
+			if (src->format->palette != NULL)
+			{
+				SDL_SetPalette(letterbox, SDL_LOGPAL|SDL_PHYSPAL, src->format->palette->colors, 0, src->format->palette->ncolors);
+			}
+			SDL_Rect dstrect = {(Sint16)leftBlackBand, (Sint16)topBlackBand, (Uint16)letterbox->w, (Uint16)letterbox->h};
+			SDL_BlitSurface(letterbox, NULL, dst, &dstrect);
 		}
-		SDL_Rect dstrect = {(Sint16)leftBlackBand, (Sint16)topBlackBand, (Uint16)tmp->w, (Uint16)tmp->h};
-		SDL_BlitSurface(tmp, NULL, dst, &dstrect);
-		SDL_FreeSurface(tmp);
 	}
 }
 
@@ -711,9 +1048,11 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
  * @param dst The zoomed surface (output).
  * @param flipx Flag indicating if the image should be horizontally flipped.
  * @param flipy Flag indicating if the image should be vertically flipped.
+ * @param yFirst First source row to zoom.
+ * @param yLast Source row past the last one to zoom.
  * @return 0 for success or -1 for error.
  */
-int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy)
+int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, int yFirst, int yLast)
 {
 	int x, y;
 	static Uint32 *sax, *say;
@@ -723,6 +1062,13 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 	int dgap;
 	static bool proclaimed = false;
 
+	yFirst = std::max(yFirst, 0);
+	yLast = std::min(yLast, src->h);
+	if (yFirst >= yLast)
+	{
+		return 0;
+	}
+
 	if (Screen::use32bitScaler())
 	{
 		if (Options::useXBRZFilter)
@@ -732,7 +1078,7 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 			{
 				if (dst->w == src->w * (int)factor && dst->h == src->h * (int)factor)
 				{
-					xbrz::scale(factor, (uint32_t*)src->pixels, (uint32_t*)dst->pixels, src->w, src->h, xbrz::RGB);
+					scaleInBands(BAND_XBRZ, factor, src, dst, yFirst, yLast);
 					return 0;
 				}
 			}
@@ -748,24 +1094,13 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 				initDone = true;
 			}
 
-			// HQX_API void HQX_CALLCONV hq2x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
-
-			if (dst->w == src->w * 2 && dst->h == src->h * 2)
-			{
-				hq2x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
-				return 0;
-			}
-
-			if (dst->w == src->w * 3 && dst->h == src->h * 3)
-			{
-				hq3x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
-				return 0;
-			}
-
-			if (dst->w == src->w * 4 && dst->h == src->h * 4)
+			for (int factor = 2; factor <= 4; factor++)
 			{
-				hq4x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
-				return 0;
+				if (dst->w == src->w * factor && dst->h == src->h * factor)
+				{
+					scaleInBands(BAND_HQX, factor, src, dst, yFirst, yLast);
+					return 0;
+				}
 			}
 		}
 	}
@@ -777,7 +1112,7 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 		{
 			if (dst->w == src->w * (int)factor && dst->h == src->h * (int)factor && !scale_precondition(factor, src->format->BytesPerPixel, src->w, src->h))
 			{
-				scale(factor, dst->pixels, dst->pitch, src->pixels, src->pitch, src->format->BytesPerPixel, src->w, src->h);
+				scaleInBands(BAND_SCALEX, factor, src, dst, yFirst, yLast);
 				return 0;
 			}
 		}
@@ -891,28 +1226,37 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 	* Draw
 	*/
 	csay = say;
+	int sy = 0;
 	for (y = 0; y < dst->h; y++) {
-		csax = sax;
-		sp = csp;
-		for (x = 0; x < dst->w; x++) {
-			/*
-			* Draw
-			*/
-			*dp = *sp;
-			/*
-			* Advance source pointers
-			*/
-			sp += (*csax);
-			csax++;
-			/*
-			* Advance destination pointer
-			*/
-			dp++;
+		/*
+		* Skip rows whose source row hasn't changed
+		*/
+		if (flipy || (sy >= yFirst && sy < yLast)) {
+			csax = sax;
+			sp = csp;
+			for (x = 0; x < dst->w; x++) {
+				/*
+				* Draw
+				*/
+				*dp = *sp;
+				/*
+				* Advance source pointers
+				*/
+				sp += (*csax);
+				csax++;
+				/*
+				* Advance destination pointer
+				*/
+				dp++;
+			}
+		} else {
+			dp += dst->w;
 		}
 		/*
 		* Advance source pointer (for row)
 		*/
 		csp += (*csay);
+		if (!flipy) sy += (*csay) / src->pitch;
 		csay++;
 
 		/*
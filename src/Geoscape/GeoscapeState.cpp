@@ -504,6 +504,8 @@ void GeoscapeState::init()
 	_globe->onMouseOver(0);
 	_globe->rotateStop();
 	_globe->setFocus(true);
+	// bases and their names may have changed while away
+	_globe->invalidate();
 	_globe->draw();
 
 	// Pop up save screen if it's a new ironman game
@@ -1069,7 +1071,7 @@ void GeoscapeState::time10Minutes()
 		// Fuel consumption for XCOM craft.
 		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
 		{
-			if ((*j)->getStatus() == "STR_OUT")
+			if ((*j)->getStatus() == Craft::STATUS_OUT)
 			{
 				(*j)->consumeFuel();
 				if (!(*j)->getLowFuel() && (*j)->getFuel() <= (*j)->getFuelLimit())
@@ -1244,7 +1246,7 @@ void GeoscapeState::time30Minutes()
 	{
 		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
 		{
-			if ((*j)->getStatus() == "STR_REFUELLING")
+			if ((*j)->getStatus() == Craft::STATUS_REFUELLING)
 			{
 				std::string item = (*j)->getRules()->getRefuelItem();
 				if (item.empty())
@@ -1268,7 +1270,7 @@ void GeoscapeState::time30Minutes()
 						popup(new CraftErrorState(this, msg));
 						if ((*j)->getFuel() > 0)
 						{
-							(*j)->setStatus("STR_READY");
+							(*j)->setStatus(Craft::STATUS_READY);
 						}
 						else
 						{
@@ -1322,7 +1324,7 @@ void GeoscapeState::time30Minutes()
 					}
 					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); !detected && c != (*b)->getCrafts()->end(); ++c)
 					{
-						if ((*c)->getStatus() == "STR_OUT" && (*c)->detect(*u))
+						if ((*c)->getStatus() == Craft::STATUS_OUT && (*c)->detect(*u))
 						{
 							detected = true;
 							break;
@@ -1353,7 +1355,7 @@ void GeoscapeState::time30Minutes()
 					}
 					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); !detected && c != (*b)->getCrafts()->end(); ++c)
 					{
-						if ((*c)->getStatus() == "STR_OUT" && (*c)->insideRadarRange(*u))
+						if ((*c)->getStatus() == Craft::STATUS_OUT && (*c)->insideRadarRange(*u))
 						{
 							detected = true;
 							hyperdetected = (*u)->getHyperDetected();
@@ -1403,11 +1405,11 @@ void GeoscapeState::time1Hour()
 	{
 		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
 		{
-			if ((*j)->getStatus() == "STR_REPAIRS")
+			if ((*j)->getStatus() == Craft::STATUS_REPAIRS)
 			{
 				(*j)->repair();
 			}
-			else if ((*j)->getStatus() == "STR_REARMING")
+			else if ((*j)->getStatus() == Craft::STATUS_REARMING)
 			{
 				std::string s = (*j)->rearm(_game->getMod());
 				if (!s.empty())
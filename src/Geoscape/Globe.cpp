@@ -18,6 +18,7 @@
  */
 #include "Globe.h"
 #include <algorithm>
+#include <cstring>
 #include "../fmath.h"
 #include "../Engine/Action.h"
 #include "../Engine/SurfaceSet.h"
@@ -53,6 +54,16 @@
 #include "../Mod/RuleGlobe.h"
 #include "../Interface/Cursor.h"
 #include "../Engine/Screen.h"
+#include "../Engine/Zoom.h"
+#if (_MSC_VER >= 1400) || (defined(__MINGW32__) && defined(__SSE2__))
+#ifndef __SSE2__
+#define __SSE2__ true
+#endif
+#include <intrin.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace OpenXcom
 {
@@ -74,6 +85,10 @@ struct GlobeStaticData
 {
 	///array of shading gradient
 	Sint16 shade_gradient[240];
+	///light value marking pixels outside of the globe
+	static const Sint16 no_earth = -1000;
+	///shading gradient extended with the values below, above and outside of its range
+	Sint16 shadow_lut[244];
 	///size of x & y of noise surface
 	const int random_surf_size;
 
@@ -157,11 +172,28 @@ struct GlobeStaticData
 			shade_gradient[i]= j+16;
 		}
 
+		//filling gradient LUT indexed by the vectorized shadow code
+		shadow_lut[0] = -31;
+		for (int i=0; i<240; ++i)
+		{
+			shadow_lut[i+1] = shade_gradient[i];
+		}
+		shadow_lut[241] = 50;
+		shadow_lut[242] = 50;
+		shadow_lut[243] = no_earth;
 	}
 };
 
 GlobeStaticData static_data;
 
+struct CopyRow
+{
+	static inline void row(Uint8* dest, const Uint8* src, const int*, const int*, const int*, int size)
+	{
+		memcpy(dest, src, size);
+	}
+};
+
 struct Ocean
 {
 	static inline void func(Uint8& dest, const int&, const int&, const int&, const int&)
@@ -172,7 +204,7 @@ struct Ocean
 
 struct CreateShadow
 {
-	static inline Uint8 getShadowValue(const Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
+	static inline Sint16 getLight(const Cord& earth, const Cord& sun)
 	{
 		Cord temp = earth;
 		//diff
@@ -188,17 +220,18 @@ struct CreateShadow
 		temp.x *= 125.;
 
 		if (temp.x < -110)
-			temp.x = -31;
+			return -31;
 		else if (temp.x > 120)
-			temp.x = 50;
+			return 50;
 		else
-			temp.x = static_data.shade_gradient[(Sint16)temp.x + 120];
-
-		temp.x -= noise;
+			return static_data.shade_gradient[(Sint16)temp.x + 120];
+	}
 
-		if (temp.x > 0.)
+	static inline Uint8 applyLight(const Uint8& dest, int light)
+	{
+		if (light > 0)
 		{
-			const Sint16 val = (temp.x> 31)? 31 : (Sint16)temp.x;
+			const Sint16 val = (light > 31)? 31 : light;
 			const int d = dest & helper::ColorGroup;
 			if (d ==  Globe::OCEAN_COLOR || d == Globe::OCEAN_COLOR + 16)
 			{
@@ -232,15 +265,82 @@ struct CreateShadow
 		}
 	}
 
-	static inline void func(Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise, const int&)
+	static inline Uint8 getShadowValue(const Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
 	{
-		if (dest && earth.z)
-			dest = getShadowValue(dest, earth, sun, noise);
+		return applyLight(dest, getLight(earth, sun) - noise);
+	}
+
+	/**
+	 * Calculates the light of a row of globe pixels from their normals.
+	 */
+	static inline void row(Sint16* light, const float* x, const float* y, const float* z, const Cord* sun, int size)
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			if (z[i])
+				light[i] = getLight(Cord(x[i], y[i], z[i]), *sun);
+			else
+				light[i] = GlobeStaticData::no_earth;
+		}
+	}
+
+	static inline void func(Uint8& dest, const Sint16& light, const Sint16& noise, const int&, const int&)
+	{
+		if (dest && light != GlobeStaticData::no_earth)
+			dest = applyLight(dest, light - noise);
 		else
 			dest = 0;
 	}
 };
 
+#ifdef __SSE2__
+
+///helper class for `Globe` calculating the light of four pixels at once
+struct CreateShadowSSE2
+{
+	static inline void row(Sint16* light, const float* x, const float* y, const float* z, const Cord* sun, int size)
+	{
+		const __m128 sunX = _mm_set1_ps((float)sun->x);
+		const __m128 sunY = _mm_set1_ps((float)sun->y);
+		const __m128 sunZ = _mm_set1_ps((float)sun->z);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128i below = _mm_setzero_si128();
+		const __m128i above = _mm_set1_epi32(242);
+		const __m128i outside = _mm_set1_epi32(243);
+		int index[4];
+
+		int i = 0;
+		for (; i + 4 <= size; i += 4)
+		{
+			const __m128 earthZ = _mm_loadu_ps(z + i);
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), sunX);
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), sunY);
+			const __m128 dz = _mm_sub_ps(earthZ, sunZ);
+			//norm of distance between 2 vectors
+			__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			t = _mm_mul_ps(_mm_sub_ps(t, _mm_set1_ps(2.0f)), _mm_set1_ps(125.0f));
+
+			//same ranges as in CreateShadow::getLight, but as indexes to `shadow_lut`
+			__m128i idx = _mm_add_epi32(_mm_cvttps_epi32(t), _mm_set1_epi32(121));
+			__m128i mask = _mm_castps_si128(_mm_cmplt_ps(t, _mm_set1_ps(-110.0f)));
+			idx = _mm_or_si128(_mm_andnot_si128(mask, idx), _mm_and_si128(mask, below));
+			mask = _mm_castps_si128(_mm_cmpgt_ps(t, _mm_set1_ps(120.0f)));
+			idx = _mm_or_si128(_mm_andnot_si128(mask, idx), _mm_and_si128(mask, above));
+			mask = _mm_castps_si128(_mm_cmpeq_ps(earthZ, zero));
+			idx = _mm_or_si128(_mm_andnot_si128(mask, idx), _mm_and_si128(mask, outside));
+
+			_mm_storeu_si128((__m128i*)index, idx);
+			light[i] = static_data.shadow_lut[index[0]];
+			light[i + 1] = static_data.shadow_lut[index[1]];
+			light[i + 2] = static_data.shadow_lut[index[2]];
+			light[i + 3] = static_data.shadow_lut[index[3]];
+		}
+		CreateShadow::row(light + i, x + i, y + i, z + i, sun, size - i);
+	}
+};
+
+#endif
+
 }//namespace
 
 
@@ -254,16 +354,18 @@ struct CreateShadow
  * @param x X position in pixels.
  * @param y Y position in pixels.
  */
-Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _cenX(cenX), _cenY(cenY), _game(game), _hover(false), _blink(-1),
+Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _cenX(cenX), _cenY(cenY), _game(game), _shadowDaylight(-1), _hover(false), _blink(-1),
 																					_isMouseScrolling(false), _isMouseScrolled(false), _xBeforeMouseScrolling(0), _yBeforeMouseScrolling(0), _lonBeforeMouseScrolling(0.0), _latBeforeMouseScrolling(0.0), _mouseScrollingStartTime(0), _totalMouseMoveX(0), _totalMouseMoveY(0), _mouseMovedOverThreshold(false)
 {
 	_rules = game->getMod()->getGlobe();
 	_texture = new SurfaceSet(*_game->getMod()->getSurfaceSet("TEXTURE.DAT"));
 	_markerSet = new SurfaceSet(*_game->getMod()->getSurfaceSet("GlobeMarkers"));
+	_markerSet->buildAtlas();
 
 	_countries = new Surface(width, height, x, y);
 	_markers = new Surface(width, height, x, y);
 	_radars = new Surface(width, height, x, y);
+	_land = new Surface(width, height, x, y);
 	_clipper = new FastLineClip(x, x+width, y, y+height);
 
 	// Animation timers
@@ -301,6 +403,7 @@ Globe::~Globe()
 	delete _texture;
 	delete _markerSet;
 	delete _radars;
+	delete _land;
 	delete _clipper;
 
 	for (std::list<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
@@ -854,6 +957,7 @@ void Globe::blink()
 		if (i->first != CITY_MARKER)
 			i->second->offset(_blink);
 	}
+	_markerSet->buildAtlas();
 
 	drawMarkers();
 }
@@ -874,21 +978,40 @@ void Globe::rotate()
 
 /**
  * Draws the whole globe, part by part.
+ * The land and details only change with the view, so they are
+ * kept until the globe is invalidated, and the shadow only
+ * needs to be applied again when the daylight changes enough.
+ * Everything that moves is redrawn every time.
  */
 void Globe::draw()
 {
-	if (_redraw)
+	const int daylight = (int)(_game->getSavedGame()->getTime()->getDaylight() * DAYLIGHT_QUANTA);
+	const bool redrawLand = _redraw;
+	if (redrawLand)
 	{
 		cachePolygons();
+		Surface::draw();
+		drawOcean();
+		drawLand();
+		// keep the unshaded land around for the next shadow update
+		ShaderDrawRow<CopyRow>(ShaderSurface(_land, 0, 0), ShaderSurface(this, 0, 0));
+	}
+	if (redrawLand || daylight != _shadowDaylight)
+	{
+		if (!redrawLand)
+		{
+			ShaderDrawRow<CopyRow>(ShaderSurface(this, 0, 0), ShaderSurface(_land, 0, 0));
+		}
+		drawShadow();
+		_shadowDaylight = daylight;
 	}
-	Surface::draw();
-	drawOcean();
-	drawLand();
 	drawRadars();
 	drawFlights();
-	drawShadow();
 	drawMarkers();
-	drawDetail();
+	if (redrawLand || _game->getSavedGame()->getDebugMode())
+	{
+		drawDetail();
+	}
 }
 
 
@@ -986,13 +1109,26 @@ Cord Globe::getSunDirection(double lon, double lat) const
 
 void Globe::drawShadow()
 {
-	ShaderMove<Cord> earth = ShaderMove<Cord>(_earthData[_zoom], getWidth(), getHeight());
+	const int moveX = _cenX-getWidth()/2, moveY = _cenY-getHeight()/2;
+	ShaderMove<float> earthX = ShaderMove<float>(_earthNormalX[_zoom], getWidth(), getHeight(), moveX, moveY);
+	ShaderMove<float> earthY = ShaderMove<float>(_earthNormalY[_zoom], getWidth(), getHeight(), moveX, moveY);
+	ShaderMove<float> earthZ = ShaderMove<float>(_earthNormalZ[_zoom], getWidth(), getHeight(), moveX, moveY);
+	ShaderMove<Sint16> light = ShaderMove<Sint16>(_shadowData, getWidth(), getHeight(), moveX, moveY);
 	ShaderRepeat<Sint16> noise = ShaderRepeat<Sint16>(_randomNoiseData, static_data.random_surf_size, static_data.random_surf_size);
+	const Cord sun = getSunDirection(_cenLon, _cenLat);
 
-	earth.setMove(_cenX-getWidth()/2, _cenY-getHeight()/2);
+	//only calculate the light of the pixels visible on the surface
+	light.setDomain(GraphSubset(getWidth(), getHeight()).offset(getX()-moveX, getY()-moveY));
+
+#ifdef __SSE2__
+	if (Zoom::haveSSE2())
+		ShaderDrawRow<CreateShadowSSE2>(light, earthX, earthY, earthZ, ShaderScalar(sun));
+	else
+#endif
+		ShaderDrawRow<CreateShadow>(light, earthX, earthY, earthZ, ShaderScalar(sun));
 
 	lock();
-	ShaderDraw<CreateShadow>(ShaderSurface(this), earth, ShaderScalar(getSunDirection(_cenLon, _cenLat)), noise);
+	ShaderDraw<CreateShadow>(ShaderSurface(this), light, noise);
 	unlock();
 
 }
@@ -1125,7 +1261,7 @@ void Globe::drawRadars()
 
 		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
 		{
-			if ((*j)->getStatus()!= "STR_OUT")
+			if ((*j)->getStatus() != Craft::STATUS_OUT)
 				continue;
 			lat=(*j)->getLatitude();
 			lon=(*j)->getLongitude();
@@ -1476,7 +1612,7 @@ void Globe::drawFlights()
 		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
 		{
 			// Hide crafts docked at base
-			if ((*j)->getStatus() != "STR_OUT" || (*j)->getDestination() == 0 /*|| pointBack((*j)->getLongitude(), (*j)->getLatitude())*/)
+			if ((*j)->getStatus() != Craft::STATUS_OUT || (*j)->getDestination() == 0 /*|| pointBack((*j)->getLongitude(), (*j)->getLatitude())*/)
 				continue;
 
 			double lon1 = (*j)->getLongitude();
@@ -1835,11 +1971,11 @@ void Globe::toggleRadarLines()
  */
 void Globe::resize()
 {
-	Surface *surfaces[4] = {this, _markers, _countries, _radars};
+	Surface *surfaces[5] = {this, _markers, _countries, _radars, _land};
 	int width = Options::baseXGeoscape - 64;
 	int height = Options::baseYGeoscape;
 
-	for (int i = 0; i < 4; ++i)
+	for (int i = 0; i < 5; ++i)
 	{
 		surfaces[i]->setWidth(width);
 		surfaces[i]->setHeight(height);
@@ -1872,16 +2008,24 @@ void Globe::setupRadii(int width, int height)
 	_radius = _zoomRadius[_zoom];
 	_radiusStep = (_zoomRadius[DOGFIGHT_ZOOM] - _zoomRadius[0]) / 10.0;
 
-	_earthData.resize(_zoomRadius.size());
+	_earthNormalX.resize(_zoomRadius.size());
+	_earthNormalY.resize(_zoomRadius.size());
+	_earthNormalZ.resize(_zoomRadius.size());
+	_shadowData.resize(width * height);
 	//filling normal field for each radius
 
 	for (size_t r = 0; r<_zoomRadius.size(); ++r)
 	{
-		_earthData[r].resize(width * height);
+		_earthNormalX[r].resize(width * height);
+		_earthNormalY[r].resize(width * height);
+		_earthNormalZ[r].resize(width * height);
 		for (int j=0; j<height; ++j)
 			for (int i=0; i<width; ++i)
 			{
-				_earthData[r][width*j + i] = static_data.circle_norm(width/2, height/2, _zoomRadius[r], i+.5, j+.5);
+				Cord norm = static_data.circle_norm(width/2, height/2, _zoomRadius[r], i+.5, j+.5);
+				_earthNormalX[r][width*j + i] = norm.x;
+				_earthNormalY[r][width*j + i] = norm.y;
+				_earthNormalZ[r][width*j + i] = norm.z;
 			}
 	}
 }
@@ -48,6 +48,7 @@ private:
 	static const int NEAR_RADIUS = 25;
 	static const size_t DOGFIGHT_ZOOM = 3;
 	static const int CITY_MARKER = 8;
+	static const int DAYLIGHT_QUANTA = 1440;
 	static const double ROTATE_LONGITUDE;
 	static const double ROTATE_LATITUDE;
 
@@ -57,15 +58,18 @@ private:
 	size_t _zoom, _zoomOld, _zoomTexture;
 	SurfaceSet *_texture, *_markerSet;
 	Game *_game;
-	Surface *_markers, *_countries, *_radars;
+	Surface *_markers, *_countries, *_radars, *_land;
+	int _shadowDaylight;
 	bool _hover;
 	int _blink;
 	Timer *_blinkTimer, *_rotTimer;
 	std::list<Polygon*> _cacheLand;
 	FastLineClip *_clipper;
 	double _radius, _radiusStep;
-	///normal of each pixel in earth globe per zoom level
-	std::vector<std::vector<Cord> > _earthData;
+	///normal of each pixel in earth globe per zoom level, one array per axis
+	std::vector<std::vector<float> > _earthNormalX, _earthNormalY, _earthNormalZ;
+	///light of each pixel in earth globe, recalculated every time the shadow is drawn
+	std::vector<Sint16> _shadowData;
 	///data sample used for noise in shading
 	std::vector<Sint16> _randomNoiseData;
 	///list of dimension of earth on screen per zoom level
@@ -19,10 +19,12 @@
 #include "MapDataSet.h"
 #include "MapData.h"
 #include <fstream>
+#include <cstring>
 #include <SDL_endian.h>
 #include "../Engine/Exception.h"
 #include "../Engine/SurfaceSet.h"
 #include "../Engine/FileMap.h"
+#include "../Engine/Logger.h"
 
 namespace OpenXcom
 {
@@ -159,14 +161,19 @@ void MapDataSet::loadData()
 
 	// Load Terrain Data from MCD file
 	std::string fname = "TERRAIN/" + _name + ".MCD";
-	std::ifstream mapFile(FileMap::getFilePath(fname).c_str(), std::ios::in | std::ios::binary);
+	const std::vector<Uint8> *mapFile = FileMap::getFileContents(fname);
 	if (!mapFile)
 	{
 		throw Exception(fname + " not found");
 	}
+	if (mapFile->size() % sizeof(MCD) != 0)
+	{
+		Log(LOG_WARNING) << fname << " has " << mapFile->size() % sizeof(MCD) << " bytes past its last record, ignoring them";
+	}
 
-	while (mapFile.read((char*)&mcd, sizeof(MCD)))
+	for (size_t offset = 0; offset + sizeof(MCD) <= mapFile->size(); offset += sizeof(MCD))
 	{
+		memcpy(&mcd, &(*mapFile)[offset], sizeof(MCD));
 		MapData *to = new MapData(this);
 		_objects.push_back(to);
 
@@ -210,18 +217,12 @@ void MapDataSet::loadData()
 		objNumber++;
 	}
 
-
-	if (!mapFile.eof())
-	{
-		throw Exception("Invalid MCD file");
-	}
-
-	mapFile.close();
-
 	// Load terrain sprites/surfaces/PCK files into a surfaceset
 	_surfaceSet = new SurfaceSet(32, 40);
 	_surfaceSet->loadPck(FileMap::getFilePath("TERRAIN/" + _name + ".PCK"),
 			     FileMap::getFilePath("TERRAIN/" + _name + ".TAB"));
+	// terrain is drawn shaded every frame, so give it the span fast path too
+	_surfaceSet->buildAtlas();
 }
 
 /**
@@ -19,6 +19,8 @@
 #include "Mod.h"
 #include <algorithm>
 #include <sstream>
+#include <fstream>
+#include <cstring>
 #include <climits>
 #include "../Engine/CrossPlatform.h"
 #include "../Engine/FileMap.h"
@@ -35,6 +37,7 @@
 #include "../Interface/Window.h"
 #include "MapDataSet.h"
 #include "RuleMusic.h"
+#include "ResearchGraph.h"
 #include "../Engine/ShaderDraw.h"
 #include "../Engine/ShaderMove.h"
 #include "../Engine/Exception.h"
@@ -88,6 +91,17 @@
 #include "RuleVideo.h"
 #include "RuleConverter.h"
 
+namespace
+{
+
+/// Most decoded music tracks kept in memory at once.
+const size_t MUSIC_CACHE_SIZE = 8;
+
+/// Identifies the transparency cache file, bump the version if its layout changes.
+const Uint32 LUT_CACHE_MAGIC = 0x54554c58, LUT_CACHE_VERSION = 1;
+
+}
+
 namespace OpenXcom
 {
 
@@ -192,8 +206,11 @@ Mod::Mod() : _costEngineer(0), _costScientist(0), _timePersonnel(0), _initialFun
 {
 	_muteMusic = new Music();
 	_muteSound = new Sound();
+	_adlibCat = _aintroCat = 0;
+	_gmCat = 0;
 	_globe = new RuleGlobe();
 	_converter = new RuleConverter();
+	_researchGraph = new ResearchGraph();
 	_statAdjustment[0].aimAndArmorMultiplier = 0.5;
 	_statAdjustment[0].growthMultiplier = 0;
 	for (int i = 1; i != 5; ++i)
@@ -210,8 +227,12 @@ Mod::~Mod()
 {
 	delete _muteMusic;
 	delete _muteSound;
+	delete _adlibCat;
+	delete _aintroCat;
+	delete _gmCat;
 	delete _globe;
 	delete _converter;
+	delete _researchGraph;
 	for (std::map<std::string, Font*>::iterator i = _fonts.begin(); i != _fonts.end(); ++i)
 	{
 		delete i->second;
@@ -399,6 +420,29 @@ T *Mod::getRule(const std::string &id, const std::string &name, const std::map<s
 	}
 }
 
+/**
+ * Assigns every rule element of a type a dense index
+ * matching its position in the sorted list, so it can be
+ * used to address flat arrays instead of looking up strings.
+ * The indices are plain ints and never saved: they change
+ * whenever the loaded mods do, so saves keep the string IDs.
+ * @param index Sorted list of the rule type.
+ * @param map Map associated to the rule type.
+ * @param byIndex Vector to fill with the rules by index.
+ */
+template <typename T>
+void Mod::indexRules(const std::vector<std::string> &index, const std::map<std::string, T*> &map, std::vector<T*> *byIndex)
+{
+	byIndex->clear();
+	byIndex->reserve(index.size());
+	for (std::vector<std::string>::const_iterator i = index.begin(); i != index.end(); ++i)
+	{
+		T *rule = map.find(*i)->second;
+		rule->setIndex(byIndex->size());
+		byIndex->push_back(rule);
+	}
+}
+
 /**
  * Returns a specific font from the mod.
  * @param name Name of the font.
@@ -426,9 +470,64 @@ Surface *Mod::getSurface(const std::string &name, bool error) const
  */
 SurfaceSet *Mod::getSurfaceSet(const std::string &name, bool error) const
 {
+	if (!_pendingSets.empty())
+	{
+		loadPendingSet(name);
+	}
 	return getRule(name, "Sprite Set", _sets, error);
 }
 
+/**
+ * Decodes a surface set that was registered at startup
+ * but left on disk until something actually asks for it.
+ * @param name Name of the surface set.
+ */
+void Mod::loadPendingSet(const std::string &name) const
+{
+	if (_pendingSets.find(name) != _pendingSets.end())
+	{
+		std::vector<std::string> names;
+		names.push_back(name);
+		preloadSurfaceSets(names);
+	}
+}
+
+/**
+ * Decodes any of the given surface sets that haven't been
+ * loaded yet, all at once, so a state can pay for the sprites
+ * it's about to use up front instead of on its first frames.
+ * @param names Names of the surface sets.
+ */
+void Mod::preloadSurfaceSets(const std::vector<std::string> &names) const
+{
+	std::vector<SurfaceSet*> sets;
+	std::vector<std::pair<std::string, std::string> > files;
+	for (std::vector<std::string>::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		std::map<std::string, std::pair<std::string, std::string> >::iterator j = _pendingSets.find(*i);
+		if (j != _pendingSets.end())
+		{
+			sets.push_back(_sets.find(*i)->second);
+			files.push_back(j->second);
+			_pendingSets.erase(j);
+		}
+	}
+	if (sets.empty())
+	{
+		return;
+	}
+	Log(LOG_VERBOSE) << "Decoding " << sets.size() << " surface sets on demand";
+	SurfaceSet::loadPcks(sets, files);
+	for (std::vector<SurfaceSet*>::iterator i = sets.begin(); i != sets.end(); ++i)
+	{
+		if (!_currentPalette.empty())
+		{
+			(*i)->setPalette(const_cast<SDL_Color*>(&_currentPalette[0]), 0, _currentPalette.size());
+		}
+		(*i)->buildAtlas();
+	}
+}
+
 /**
  * Returns a specific music from the mod.
  * @param name Name of the music.
@@ -442,10 +541,63 @@ Music *Mod::getMusic(const std::string &name, bool error) const
 	}
 	else
 	{
+		loadMusicTrack(name);
 		return getRule(name, "Music", _musics, error);
 	}
 }
 
+/**
+ * Returns a music track, decoding it first if it isn't in memory.
+ * Only the most recently used tracks are kept; loading a new one
+ * frees the oldest, which is fine since every caller starts
+ * playing the track it asked for straight away.
+ * @param name Name of the music.
+ * @return Pointer to the music, or NULL if it couldn't be loaded.
+ */
+Music *Mod::loadMusicTrack(const std::string &name) const
+{
+	std::map<std::string, Music*>::iterator i = _musics.find(name);
+	if (i != _musics.end())
+	{
+		_musicCache.remove(name);
+		_musicCache.push_front(name);
+		return i->second;
+	}
+#ifdef __NO_MUSIC
+	return 0;
+#else
+	std::map<std::string, RuleMusic*>::const_iterator def = _musicDefs.find(name);
+	if (def == _musicDefs.end() || _missingMusic.find(name) != _missingMusic.end())
+	{
+		return 0;
+	}
+
+	// Try the preferred format first, otherwise use the default priority
+	MusicFormat priority[] = { Options::preferredMusic, MUSIC_FLAC, MUSIC_OGG, MUSIC_MP3, MUSIC_MOD, MUSIC_WAV, MUSIC_ADLIB, MUSIC_MIDI };
+	Music *music = 0;
+	for (size_t j = 0; j < sizeof(priority) / sizeof(priority[0]) && music == 0; ++j)
+	{
+		music = loadMusic(priority[j], name, def->second->getCatPos(), def->second->getNormalization(), _adlibCat, _aintroCat, _gmCat);
+	}
+	if (music == 0)
+	{
+		_missingMusic.insert(name);
+		return 0;
+	}
+
+	while (_musicCache.size() >= MUSIC_CACHE_SIZE)
+	{
+		std::map<std::string, Music*>::iterator oldest = _musics.find(_musicCache.back());
+		delete oldest->second;
+		_musics.erase(oldest);
+		_musicCache.pop_back();
+	}
+	_musics[name] = music;
+	_musicCache.push_front(name);
+	return music;
+#endif
+}
+
 /**
  * Returns a random music from the mod.
  * @param name Name of the music to pick from.
@@ -459,22 +611,26 @@ Music *Mod::getRandomMusic(const std::string &name) const
 	}
 	else
 	{
-		std::vector<Music*> music;
-		for (std::map<std::string, Music*>::const_iterator i = _musics.begin(); i != _musics.end(); ++i)
+		std::vector<std::string> music;
+		for (std::map<std::string, RuleMusic*>::const_iterator i = _musicDefs.begin(); i != _musicDefs.end(); ++i)
 		{
-			if (i->first.find(name) != std::string::npos)
+			if (i->first.find(name) != std::string::npos && _missingMusic.find(i->first) == _missingMusic.end())
 			{
-				music.push_back(i->second);
+				music.push_back(i->first);
 			}
 		}
-		if (music.empty())
-		{
-			return _muteMusic;
-		}
-		else
+		// tracks without any files only show up once we try them
+		while (!music.empty())
 		{
-			return music[RNG::seedless(0, music.size() - 1)];
+			size_t pick = RNG::seedless(0, music.size() - 1);
+			Music *track = loadMusicTrack(music[pick]);
+			if (track)
+			{
+				return track;
+			}
+			music.erase(music.begin() + pick);
 		}
+		return _muteMusic;
 	}
 }
 
@@ -574,6 +730,9 @@ Palette *Mod::getPalette(const std::string &name, bool error) const
  */
 void Mod::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 {
+	// remembered for sets that get decoded later on
+	_currentPalette.resize(256);
+	std::copy(colors, colors + ncolors, _currentPalette.begin() + firstcolor);
 	for (std::map<std::string, Font*>::iterator i = _fonts.begin(); i != _fonts.end(); ++i)
 	{
 		i->second->setPalette(colors, firstcolor, ncolors);
@@ -638,6 +797,7 @@ int Mod::getModOffset() const
  */
 int Mod::getSpriteOffset(int sprite, const std::string& set) const
 {
+	loadPendingSet(set);
 	std::map<std::string, SurfaceSet*>::const_iterator i = _sets.find(set);
 	if (i != _sets.end() && sprite >= (int)i->second->getTotalFrames())
 		return sprite + _modOffset;
@@ -698,8 +858,18 @@ void Mod::loadAll(const std::vector< std::pair< std::string, std::vector<std::st
 		}
 	}
 	sortLists();
+	indexLists();
+	_researchGraph->build(this);
 	loadExtraResources();
 	modResources();
+	for (std::map<std::string, SurfaceSet*>::iterator i = _sets.begin(); i != _sets.end(); ++i)
+	{
+		// sets still on disk get their atlas when they're decoded
+		if (_pendingSets.find(i->first) == _pendingSets.end())
+		{
+			i->second->buildAtlas();
+		}
+	}
 }
 
 /**
@@ -1501,6 +1671,20 @@ const std::vector<std::string> &Mod::getBaseFacilitiesList() const
 	return _facilitiesIndex;
 }
 
+/**
+ * Returns the rules for the facility with the specified index.
+ * @param index Facility index, as assigned after loading all mods.
+ * @return Rules for the facility, or NULL if the index is out of range.
+ */
+RuleBaseFacility *Mod::getBaseFacilityByIndex(int index) const
+{
+	if (index < 0 || index >= (int)_facilitiesByIndex.size())
+	{
+		return 0;
+	}
+	return _facilitiesByIndex[index];
+}
+
 /**
  * Returns the rules for the specified craft.
  * @param id Craft type.
@@ -1521,6 +1705,20 @@ const std::vector<std::string> &Mod::getCraftsList() const
 	return _craftsIndex;
 }
 
+/**
+ * Returns the rules for the craft with the specified index.
+ * @param index Craft index, as assigned after loading all mods.
+ * @return Rules for the craft, or NULL if the index is out of range.
+ */
+RuleCraft *Mod::getCraftByIndex(int index) const
+{
+	if (index < 0 || index >= (int)_craftsByIndex.size())
+	{
+		return 0;
+	}
+	return _craftsByIndex[index];
+}
+
 /**
  * Returns the rules for the specified craft weapon.
  * @param id Craft weapon type.
@@ -1565,6 +1763,20 @@ const std::vector<std::string> &Mod::getItemsList() const
 	return _itemsIndex;
 }
 
+/**
+ * Returns the rules for the item with the specified index.
+ * @param index Item index, as assigned after loading all mods.
+ * @return Rules for the item, or NULL if the index is out of range.
+ */
+RuleItem *Mod::getItemByIndex(int index) const
+{
+	if (index < 0 || index >= (int)_itemsByIndex.size())
+	{
+		return 0;
+	}
+	return _itemsByIndex[index];
+}
+
 /**
  * Returns the rules for the specified UFO.
  * @param id UFO type.
@@ -1831,6 +2043,20 @@ const std::vector<std::string> &Mod::getResearchList() const
 	return _researchIndex;
 }
 
+/**
+ * Returns the rules for the research project with the specified index.
+ * @param index Research project index, as assigned after loading all mods.
+ * @return Rules for the research project, or NULL if the index is out of range.
+ */
+RuleResearch *Mod::getResearchByIndex(int index) const
+{
+	if (index < 0 || index >= (int)_researchByIndex.size())
+	{
+		return 0;
+	}
+	return _researchByIndex[index];
+}
+
 /**
  * Returns the rules for the specified manufacture project.
  * @param id Manufacture project type.
@@ -1850,6 +2076,30 @@ const std::vector<std::string> &Mod::getManufactureList() const
 	return _manufactureIndex;
 }
 
+/**
+ * Returns the rules for the manufacture project with the specified index.
+ * @param index Manufacture project index, as assigned after loading all mods.
+ * @return Rules for the manufacture project, or NULL if the index is out of range.
+ */
+RuleManufacture *Mod::getManufactureByIndex(int index) const
+{
+	if (index < 0 || index >= (int)_manufactureByIndex.size())
+	{
+		return 0;
+	}
+	return _manufactureByIndex[index];
+}
+
+/**
+ * Returns the research and manufacture rules compiled
+ * into a graph for quickly tracking research progress.
+ * @return Pointer to the research graph.
+ */
+const ResearchGraph *Mod::getResearchGraph() const
+{
+	return _researchGraph;
+}
+
 /**
  * Generates and returns a list of facilities for custom bases.
  * The list contains all the facilities that are listed in the 'startingBase'
@@ -2127,6 +2377,20 @@ void Mod::sortLists()
 	std::sort(_ufopaediaIndex.begin(), _ufopaediaIndex.end(), compareRule<ArticleDefinition>(this));
 }
 
+/**
+ * Assigns dense indices to the rulesets that are
+ * commonly looked up at runtime. Save files keep
+ * using the string types, as indices depend on the mods.
+ */
+void Mod::indexLists()
+{
+	indexRules(_itemsIndex, _items, &_itemsByIndex);
+	indexRules(_craftsIndex, _crafts, &_craftsByIndex);
+	indexRules(_facilitiesIndex, _facilities, &_facilitiesByIndex);
+	indexRules(_researchIndex, _research, &_researchByIndex);
+	indexRules(_manufactureIndex, _manufacture, &_manufactureByIndex);
+}
+
 /**
  * Gets the research-requirements for Psi-Lab (it's a cache for psiStrengthEval)
  */
@@ -2667,9 +2931,11 @@ void Mod::loadBattlescapeResources()
 			_sets[fname] = new SurfaceSet(32, 40);
 		else
 			_sets[fname] = new SurfaceSet(32, 48);
-		_sets[fname]->loadPck(path, tab);
+		// most unit sets only matter in battle, so leave them on disk until then
+		_pendingSets[fname] = std::make_pair(path, tab);
 	}
 	// incomplete chryssalid set: 1.0 data: stop loading.
+	loadPendingSet("CHRYS.PCK");
 	if (_sets.find("CHRYS.PCK") != _sets.end() && !_sets["CHRYS.PCK"]->getFrame(225))
 	{
 		Log(LOG_FATAL) << "Version 1.0 data detected";
@@ -2710,6 +2976,7 @@ void Mod::loadBattlescapeResources()
 	{ 2, 0, 24, 255 } };
 
 	std::set<std::string> ufographContents = FileMap::getVFolderContents("UFOGRAPH");
+	loadLUTCache();
 	for (size_t i = 0; i < sizeof(lbms) / sizeof(lbms[0]); ++i)
 	{
 		if (ufographContents.find(lbms[i]) == ufographContents.end())
@@ -2731,6 +2998,7 @@ void Mod::loadBattlescapeResources()
 		createTransparencyLUT(_palettes[pals[i]]);
 		delete tempSurface;
 	}
+	saveLUTCache();
 
 	std::string spks[] = { "TAC01.SCR",
 		"DETBORD.PCK",
@@ -2793,6 +3061,7 @@ void Mod::loadBattlescapeResources()
 
 		//personal armor
 		name = "XCOM_1.PCK";
+		loadPendingSet(name);
 		if (_sets.find(name) != _sets.end())
 		{
 			SurfaceSet *xcom_1 = _sets[name];
@@ -2837,6 +3106,7 @@ void Mod::loadBattlescapeResources()
 		for (int j = 0; j < 3; ++j)
 		{
 			name[7] = '0' + j;
+			loadPendingSet(name);
 			if (_sets.find(name) != _sets.end())
 			{
 				SurfaceSet *xcom_2 = _sets[name];
@@ -2937,50 +3207,25 @@ void Mod::loadExtraResources()
 	}
 
 #ifndef __NO_MUSIC
-	// Load musics
+	// Open the music catalogs, the tracks themselves are decoded on first use
 	if (!Options::mute)
 	{
 		const std::set<std::string> &soundFiles(FileMap::getVFolderContents("SOUND"));
-
-		// Check which music version is available
-		CatFile *adlibcat = 0, *aintrocat = 0;
-		GMCatFile *gmcat = 0;
-
 		for (std::set<std::string>::iterator i = soundFiles.begin(); i != soundFiles.end(); ++i)
 		{
 			if (0 == i->compare("adlib.cat"))
 			{
-				adlibcat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
+				_adlibCat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
 			}
 			else if (0 == i->compare("aintro.cat"))
 			{
-				aintrocat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
+				_aintroCat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
 			}
 			else if (0 == i->compare("gm.cat"))
 			{
-				gmcat = new GMCatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
-			}
-		}
-
-		// Try the preferred format first, otherwise use the default priority
-		MusicFormat priority[] = { Options::preferredMusic, MUSIC_FLAC, MUSIC_OGG, MUSIC_MP3, MUSIC_MOD, MUSIC_WAV, MUSIC_ADLIB, MUSIC_MIDI };
-		for (std::map<std::string, RuleMusic *>::const_iterator i = _musicDefs.begin(); i != _musicDefs.end(); ++i)
-		{
-			Music *music = 0;
-			for (size_t j = 0; j < sizeof(priority) / sizeof(priority[0]) && music == 0; ++j)
-			{
-				music = loadMusic(priority[j], (*i).first, (*i).second->getCatPos(), (*i).second->getNormalization(), adlibcat, aintrocat, gmcat);
-			}
-			if (music)
-			{
-				_musics[(*i).first] = music;
+				_gmCat = new GMCatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
 			}
-
 		}
-
-		delete gmcat;
-		delete adlibcat;
-		delete aintrocat;
 	}
 #endif
 
@@ -3008,6 +3253,7 @@ void Mod::loadExtraResources()
 		else
 		{
 			bool adding = false;
+			loadPendingSet(sheetName);
 			if (_sets.find(sheetName) == _sets.end())
 			{
 				Log(LOG_VERBOSE) << "Creating new surface set: " << sheetName;
@@ -3269,6 +3515,7 @@ void Mod::modResources()
 
 	// copy constructor doesn't like doing this directly, so let's make a second handobs file the old fashioned way.
 	// handob2 is used for all the left handed sprites.
+	loadPendingSet("HANDOB.PCK");
 	_sets["HANDOB2.PCK"] = new SurfaceSet(_sets["HANDOB.PCK"]->getWidth(), _sets["HANDOB.PCK"]->getHeight());
 	std::map<int, Surface*> *handob = _sets["HANDOB.PCK"]->getFrames();
 	for (std::map<int, Surface*>::const_iterator i = handob->begin(); i != handob->end(); ++i)
@@ -3411,6 +3658,29 @@ Music *Mod::loadMusic(MusicFormat fmt, const std::string &file, int track, float
  */
 void Mod::createTransparencyLUT(Palette *pal)
 {
+	// the table only depends on the palette and the tints, so they make up the cache key
+	std::vector<Uint8> key;
+	for (std::vector<SDL_Color>::const_iterator tint = _transparencies.begin(); tint != _transparencies.end(); ++tint)
+	{
+		key.push_back(tint->r);
+		key.push_back(tint->g);
+		key.push_back(tint->b);
+		key.push_back(tint->unused);
+	}
+	for (int currentColor = 0; currentColor < 256; ++currentColor)
+	{
+		key.push_back(pal->getColors(currentColor)->r);
+		key.push_back(pal->getColors(currentColor)->g);
+		key.push_back(pal->getColors(currentColor)->b);
+	}
+	std::map<std::vector<Uint8>, std::vector<Uint8> >::const_iterator cached = _lutCache.find(key);
+	if (cached != _lutCache.end())
+	{
+		_transparencyLUTs.push_back(cached->second);
+		_lutCacheUsed.insert(*cached);
+		return;
+	}
+
 	SDL_Color desiredColor;
 	std::vector<Uint8> lookUpTable;
 	// start with the color sets
@@ -3450,6 +3720,96 @@ void Mod::createTransparencyLUT(Palette *pal)
 		}
 	}
 	_transparencyLUTs.push_back(lookUpTable);
+	_lutCacheUsed[key] = lookUpTable;
+}
+
+/**
+ * Reads the transparency tables worked out on previous runs from
+ * the user folder. Each one is stored along with the palette and
+ * tints it was built from, so a table is only reused if those
+ * match exactly, and changing a mod simply misses the cache.
+ */
+void Mod::loadLUTCache()
+{
+	_lutCache.clear();
+	_lutCacheUsed.clear();
+	std::vector<Uint8> data;
+	if (!CrossPlatform::readFile(Options::getUserFolder() + "transparency.cache", data))
+	{
+		return;
+	}
+
+	size_t pos = 0;
+	Uint32 header[3];
+	if (data.size() < sizeof(header))
+	{
+		return;
+	}
+	memcpy(header, &data[0], sizeof(header));
+	pos += sizeof(header);
+	if (header[0] != LUT_CACHE_MAGIC || header[1] != LUT_CACHE_VERSION)
+	{
+		return;
+	}
+	for (Uint32 i = 0; i < header[2]; ++i)
+	{
+		std::vector<Uint8> blobs[2];
+		for (int j = 0; j < 2; ++j)
+		{
+			Uint32 size;
+			if (data.size() - pos < sizeof(size))
+			{
+				Log(LOG_WARNING) << "Truncated transparency cache, ignoring it";
+				_lutCache.clear();
+				return;
+			}
+			memcpy(&size, &data[pos], sizeof(size));
+			pos += sizeof(size);
+			if (data.size() - pos < size)
+			{
+				Log(LOG_WARNING) << "Truncated transparency cache, ignoring it";
+				_lutCache.clear();
+				return;
+			}
+			blobs[j].assign(data.begin() + pos, data.begin() + pos + size);
+			pos += size;
+		}
+		_lutCache[blobs[0]] = blobs[1];
+	}
+}
+
+/**
+ * Writes out the transparency tables used by this run, dropping
+ * any that went stale, so the next start can skip building them.
+ */
+void Mod::saveLUTCache()
+{
+	if (_lutCacheUsed != _lutCache)
+	{
+		std::string path = Options::getUserFolder() + "transparency.cache";
+		std::ofstream out(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		Uint32 header[3] = { LUT_CACHE_MAGIC, LUT_CACHE_VERSION, (Uint32)_lutCacheUsed.size() };
+		out.write((const char*)header, sizeof(header));
+		for (std::map<std::vector<Uint8>, std::vector<Uint8> >::const_iterator i = _lutCacheUsed.begin(); i != _lutCacheUsed.end(); ++i)
+		{
+			const std::vector<Uint8> *blobs[2] = { &i->first, &i->second };
+			for (int j = 0; j < 2; ++j)
+			{
+				Uint32 size = blobs[j]->size();
+				out.write((const char*)&size, sizeof(size));
+				if (size > 0)
+				{
+					out.write((const char*)&(*blobs[j])[0], size);
+				}
+			}
+		}
+		if (!out)
+		{
+			Log(LOG_WARNING) << "Failed to write " << path;
+		}
+	}
+	_lutCache.clear();
+	_lutCacheUsed.clear();
 }
 
 StatAdjustment *Mod::getStatAdjustment(int difficulty)
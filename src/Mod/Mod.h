@@ -18,6 +18,8 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <map>
+#include <list>
+#include <set>
 #include <vector>
 #include <string>
 #include <SDL.h>
@@ -73,6 +75,7 @@ class StatString;
 class RuleInterface;
 class RuleGlobe;
 class RuleConverter;
+class ResearchGraph;
 class SoundDefinition;
 class MapScript;
 class RuleVideo;
@@ -96,9 +99,16 @@ private:
 	std::map<std::string, Surface*> _surfaces;
 	std::map<std::string, SurfaceSet*> _sets;
 	std::map<std::string, SoundSet*> _sounds;
-	std::map<std::string, Music*> _musics;
+	mutable std::map<std::string, Music*> _musics;
+	mutable std::map<std::string, std::pair<std::string, std::string> > _pendingSets;
+	mutable std::list<std::string> _musicCache;
+	mutable std::set<std::string> _missingMusic;
+	CatFile *_adlibCat, *_aintroCat;
+	GMCatFile *_gmCat;
+	std::vector<SDL_Color> _currentPalette;
 	std::vector<Uint16> _voxelData;
 	std::vector<std::vector<Uint8> > _transparencyLUTs;
+	std::map<std::vector<Uint8>, std::vector<Uint8> > _lutCache, _lutCacheUsed;
 
 	std::map<std::string, RuleCountry*> _countries;
 	std::map<std::string, RuleRegion*> _regions;
@@ -134,6 +144,7 @@ private:
 	std::map<std::string, RuleMusic *> _musicDefs;
 	RuleGlobe *_globe;
 	RuleConverter *_converter;
+	ResearchGraph *_researchGraph;
 	int _costEngineer, _costScientist, _timePersonnel, _initialFunding, _turnAIUseGrenade, _turnAIUseBlaster, _defeatScore, _defeatFunds;
 	std::pair<std::string, int> _alienFuel;
 	std::string _fontName, _finalResearch;
@@ -144,6 +155,11 @@ private:
 	std::vector<std::string> _countriesIndex, _regionsIndex, _facilitiesIndex, _craftsIndex, _craftWeaponsIndex, _itemsIndex, _invsIndex, _ufosIndex;
 	std::vector<std::string> _soldiersIndex, _aliensIndex, _deploymentsIndex, _armorsIndex, _ufopaediaIndex, _ufopaediaCatIndex, _researchIndex, _manufactureIndex, _MCDPatchesIndex;
 	std::vector<std::string> _alienMissionsIndex, _terrainIndex, _extraSpritesIndex, _extraSoundsIndex, _extraStringsIndex, _missionScriptIndex;
+	std::vector<RuleItem*> _itemsByIndex;
+	std::vector<RuleCraft*> _craftsByIndex;
+	std::vector<RuleBaseFacility*> _facilitiesByIndex;
+	std::vector<RuleResearch*> _researchByIndex;
+	std::vector<RuleManufacture*> _manufactureByIndex;
 	std::vector<std::vector<int> > _alienItemLevels;
 	std::vector<SDL_Color> _transparencies;
 	int _facilityListOrder, _craftListOrder, _itemListOrder, _researchListOrder,  _manufactureListOrder, _ufopaediaListOrder, _invListOrder;
@@ -158,6 +174,9 @@ private:
 	/// Gets a ruleset element.
 	template <typename T>
 	T *getRule(const std::string &id, const std::string &name, const std::map<std::string, T*> &map, bool error) const;
+	/// Assigns dense indices to a ruleset type.
+	template <typename T>
+	void indexRules(const std::vector<std::string> &index, const std::map<std::string, T*> &map, std::vector<T*> *byIndex);
 	/// Gets a random music. This is private to prevent access, use playMusic(name, true) instead.
 	Music *getRandomMusic(const std::string &name) const;
 	/// Gets a particular sound set. This is private to prevent access, use getSound(name, id) instead.
@@ -166,10 +185,18 @@ private:
 	void loadBattlescapeResources();
 	/// Checks if an extension is a valid image file.
 	bool isImageFile(std::string extension) const;
+	/// Decodes a surface set that was left for loading on demand.
+	void loadPendingSet(const std::string &name) const;
+	/// Loads a music track on demand.
+	Music *loadMusicTrack(const std::string &name) const;
 	/// Loads a specified music file.
 	Music *loadMusic(MusicFormat fmt, const std::string &file, int track, float volume, CatFile *adlibcat, CatFile *aintrocat, GMCatFile *gmcat) const;
 	/// Creates a transparency lookup table for a given palette.
 	void createTransparencyLUT(Palette *pal);
+	/// Reads the transparency tables cached by earlier runs.
+	void loadLUTCache();
+	/// Writes out the transparency tables used by this run.
+	void saveLUTCache();
 	/// Loads a specified mod content.
 	void loadMod(const std::vector<std::string> &rulesetFiles, size_t modIdx);
 	/// Loads resources from vanilla.
@@ -180,6 +207,8 @@ private:
 	void modResources();
 	/// Sorts all our lists according to their weight.
 	void sortLists();
+	/// Assigns dense indices to all the indexed rulesets.
+	void indexLists();
 public:
 	static int DOOR_OPEN;
 	static int SLIDING_DOOR_OPEN;
@@ -226,6 +255,8 @@ public:
 	Surface *getSurface(const std::string &name, bool error = true) const;
 	/// Gets a particular surface set.
 	SurfaceSet *getSurfaceSet(const std::string &name, bool error = true) const;
+	/// Decodes a list of surface sets ahead of time.
+	void preloadSurfaceSets(const std::vector<std::string> &names) const;
 	/// Gets a particular music.
 	Music *getMusic(const std::string &name, bool error = true) const;
 	/// Plays a particular music.
@@ -265,10 +296,14 @@ public:
 	RuleBaseFacility *getBaseFacility(const std::string &id, bool error = false) const;
 	/// Gets the available facilities.
 	const std::vector<std::string> &getBaseFacilitiesList() const;
+	/// Gets the ruleset for a facility index.
+	RuleBaseFacility *getBaseFacilityByIndex(int index) const;
 	/// Gets the ruleset for a craft type.
 	RuleCraft *getCraft(const std::string &id, bool error = false) const;
 	/// Gets the available crafts.
 	const std::vector<std::string> &getCraftsList() const;
+	/// Gets the ruleset for a craft index.
+	RuleCraft *getCraftByIndex(int index) const;
 	/// Gets the ruleset for a craft weapon type.
 	RuleCraftWeapon *getCraftWeapon(const std::string &id, bool error = false) const;
 	/// Gets the available craft weapons.
@@ -277,6 +312,8 @@ public:
 	RuleItem *getItem(const std::string &id, bool error = false) const;
 	/// Gets the available items.
 	const std::vector<std::string> &getItemsList() const;
+	/// Gets the ruleset for an item index.
+	RuleItem *getItemByIndex(int index) const;
 	/// Gets the ruleset for a UFO type.
 	RuleUfo *getUfo(const std::string &id, bool error = false) const;
 	/// Gets the available UFOs.
@@ -327,10 +364,16 @@ public:
 	RuleResearch *getResearch (const std::string &id, bool error = false) const;
 	/// Gets the list of all research projects.
 	const std::vector<std::string> &getResearchList() const;
+	/// Gets the ruleset for a research project index.
+	RuleResearch *getResearchByIndex(int index) const;
 	/// Gets the ruleset for a specific manufacture project.
 	RuleManufacture *getManufacture (const std::string &id, bool error = false) const;
 	/// Gets the list of all manufacture projects.
 	const std::vector<std::string> &getManufactureList() const;
+	/// Gets the ruleset for a manufacture project index.
+	RuleManufacture *getManufactureByIndex(int index) const;
+	/// Gets the compiled research and manufacture graph.
+	const ResearchGraph *getResearchGraph() const;
 	/// Gets facilities for custom bases.
 	std::vector<RuleBaseFacility*> getCustomBaseFacilities() const;
 	/// Gets a specific UfoTrajectory.
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ResearchGraph.h"
+#include <set>
+#include "Mod.h"
+#include "RuleResearch.h"
+#include "RuleManufacture.h"
+#include "../Engine/Logger.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates an empty research graph.
+ */
+ResearchGraph::ResearchGraph()
+{
+}
+
+/**
+ *
+ */
+ResearchGraph::~ResearchGraph()
+{
+}
+
+/**
+ * Resolves a list of research IDs to the indices of
+ * the topics, ignoring duplicates.
+ * @param indices Map of research IDs to indices.
+ * @param names List of research IDs.
+ * @param resolved Set to fill with the indices.
+ * @return Amount of IDs that don't match any topic.
+ */
+static int resolve(const std::map<std::string, int> &indices, const std::vector<std::string> &names, std::set<int> *resolved)
+{
+	std::set<std::string> missing;
+	for (std::vector<std::string>::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		std::map<std::string, int>::const_iterator j = indices.find(*i);
+		if (j != indices.end())
+		{
+			resolved->insert(j->second);
+		}
+		else
+		{
+			missing.insert(*i);
+		}
+	}
+	return missing.size();
+}
+
+/**
+ * Compiles the research and manufacture rules into the graph.
+ * Prerequisites that don't match any topic are counted, but
+ * can never be met, same as when comparing the IDs directly.
+ * @param mod Pointer to mod, with the rules already indexed.
+ */
+void ResearchGraph::build(const Mod *mod)
+{
+	size_t research = mod->getResearchList().size();
+	size_t manufacture = mod->getManufactureList().size();
+
+	_indices.clear();
+	for (size_t i = 0; i != research; ++i)
+	{
+		_indices[mod->getResearchByIndex(i)->getName()] = i;
+	}
+
+	_dependencies.assign(research, 0);
+	_requirements.assign(research, 0);
+	_getOneFree.assign(research, 0);
+	_protectedUnlocks.assign(research, 0);
+	_protected.assign(research, false);
+	_dependents.assign(research, std::vector<int>());
+	_requiredBy.assign(research, std::vector<int>());
+	_unlocks.assign(research, std::vector<int>());
+	_unlockedBy.assign(research, std::vector<int>());
+	_freeFrom.assign(research, std::vector<int>());
+	_manufactureRequiredBy.assign(research, std::vector<int>());
+	_manufactureRequirements.assign(manufacture, 0);
+
+	for (size_t i = 0; i != research; ++i)
+	{
+		_protected[i] = !mod->getResearchByIndex(i)->getRequirements().empty();
+	}
+
+	for (size_t i = 0; i != research; ++i)
+	{
+		const RuleResearch *rule = mod->getResearchByIndex(i);
+		std::set<int> edges;
+
+		_dependencies[i] = resolve(_indices, rule->getDependencies(), &edges);
+		_dependencies[i] += edges.size();
+		for (std::set<int>::const_iterator j = edges.begin(); j != edges.end(); ++j)
+		{
+			_dependents[*j].push_back(i);
+		}
+
+		edges.clear();
+		_requirements[i] = resolve(_indices, rule->getRequirements(), &edges);
+		_requirements[i] += edges.size();
+		for (std::set<int>::const_iterator j = edges.begin(); j != edges.end(); ++j)
+		{
+			_requiredBy[*j].push_back(i);
+		}
+
+		edges.clear();
+		_getOneFree[i] = resolve(_indices, rule->getGetOneFree(), &edges);
+		_getOneFree[i] += edges.size();
+		for (std::set<int>::const_iterator j = edges.begin(); j != edges.end(); ++j)
+		{
+			_freeFrom[*j].push_back(i);
+		}
+
+		edges.clear();
+		if (resolve(_indices, rule->getUnlocked(), &edges) != 0)
+		{
+			Log(LOG_ERROR) << "Research " << rule->getName() << " unlocks an unknown research topic";
+		}
+		for (std::set<int>::const_iterator j = edges.begin(); j != edges.end(); ++j)
+		{
+			_unlocks[i].push_back(*j);
+			if (_protected[*j])
+			{
+				_unlockedBy[*j].push_back(i);
+				_protectedUnlocks[i]++;
+			}
+		}
+	}
+
+	for (size_t i = 0; i != manufacture; ++i)
+	{
+		std::set<int> edges;
+		_manufactureRequirements[i] = resolve(_indices, mod->getManufactureByIndex(i)->getRequirements(), &edges);
+		_manufactureRequirements[i] += edges.size();
+		for (std::set<int>::const_iterator j = edges.begin(); j != edges.end(); ++j)
+		{
+			_manufactureRequiredBy[*j].push_back(i);
+		}
+	}
+}
+
+/**
+ * Returns the index of a research topic.
+ * @param name Research ID.
+ * @return Research index, or -1 if not found.
+ */
+int ResearchGraph::getIndex(const std::string &name) const
+{
+	std::map<std::string, int>::const_iterator i = _indices.find(name);
+	if (i == _indices.end())
+	{
+		return -1;
+	}
+	return i->second;
+}
+
+/**
+ * Returns the manufacture projects that list
+ * a research topic in their requirements.
+ * @param index Research index.
+ * @return List of manufacture indices.
+ */
+const std::vector<int> &ResearchGraph::getManufactureRequiredBy(int index) const
+{
+	return _manufactureRequiredBy[index];
+}
+
+/**
+ * Resets a research progress to the state
+ * of a game with nothing discovered yet.
+ * @param progress Progress to reset.
+ */
+void ResearchGraph::reset(ResearchProgress *progress) const
+{
+	progress->researched.assign(_dependencies.size(), 0);
+	progress->unmetDependencies = _dependencies;
+	progress->unmetRequirements = _requirements;
+	progress->unlockers.assign(_dependencies.size(), 0);
+	progress->undiscoveredFree = _getOneFree;
+	progress->undiscoveredProtectedUnlocks = _protectedUnlocks;
+	progress->unmetManufacture = _manufactureRequirements;
+}
+
+/**
+ * Marks a research topic as discovered and updates
+ * the counters of every topic and project referencing it.
+ * @param progress Progress to update.
+ * @param index Research index.
+ * @return False if the topic was already discovered.
+ */
+bool ResearchGraph::discover(ResearchProgress *progress, int index) const
+{
+	if (progress->researched[index])
+	{
+		return false;
+	}
+	progress->researched[index] = 1;
+	for (std::vector<int>::const_iterator i = _dependents[index].begin(); i != _dependents[index].end(); ++i)
+	{
+		progress->unmetDependencies[*i]--;
+	}
+	for (std::vector<int>::const_iterator i = _requiredBy[index].begin(); i != _requiredBy[index].end(); ++i)
+	{
+		progress->unmetRequirements[*i]--;
+	}
+	for (std::vector<int>::const_iterator i = _unlocks[index].begin(); i != _unlocks[index].end(); ++i)
+	{
+		progress->unlockers[*i]++;
+	}
+	for (std::vector<int>::const_iterator i = _freeFrom[index].begin(); i != _freeFrom[index].end(); ++i)
+	{
+		progress->undiscoveredFree[*i]--;
+	}
+	for (std::vector<int>::const_iterator i = _unlockedBy[index].begin(); i != _unlockedBy[index].end(); ++i)
+	{
+		progress->undiscoveredProtectedUnlocks[*i]--;
+	}
+	for (std::vector<int>::const_iterator i = _manufactureRequiredBy[index].begin(); i != _manufactureRequiredBy[index].end(); ++i)
+	{
+		progress->unmetManufacture[*i]--;
+	}
+	return true;
+}
+
+}
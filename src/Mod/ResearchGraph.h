@@ -0,0 +1,71 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+#include <map>
+
+namespace OpenXcom
+{
+
+class Mod;
+
+/**
+ * Per-game state of the research graph: which topics are
+ * discovered, and how many prerequisites each topic is still missing.
+ * Indexed the same as the research and manufacture rules.
+ */
+struct ResearchProgress
+{
+	std::vector<char> researched;
+	std::vector<int> unmetDependencies, unmetRequirements, unlockers, undiscoveredFree, undiscoveredProtectedUnlocks;
+	std::vector<int> unmetManufacture;
+};
+
+/**
+ * Research and manufacture rules compiled into an indexed graph.
+ * Every edge points from a topic to the topics and projects that
+ * reference it, so discovering a topic only needs to update
+ * its dependents instead of re-checking every rule.
+ */
+class ResearchGraph
+{
+private:
+	std::map<std::string, int> _indices;
+	std::vector<int> _dependencies, _requirements, _getOneFree, _protectedUnlocks, _manufactureRequirements;
+	std::vector<bool> _protected;
+	std::vector<std::vector<int> > _dependents, _requiredBy, _unlocks, _unlockedBy, _freeFrom, _manufactureRequiredBy;
+public:
+	/// Creates an empty research graph.
+	ResearchGraph();
+	/// Cleans up the research graph.
+	~ResearchGraph();
+	/// Compiles the graph from the mod rules.
+	void build(const Mod *mod);
+	/// Gets the index of a research topic.
+	int getIndex(const std::string &name) const;
+	/// Gets the manufacture projects requiring a research topic.
+	const std::vector<int> &getManufactureRequiredBy(int index) const;
+	/// Resets a progress to nothing discovered.
+	void reset(ResearchProgress *progress) const;
+	/// Marks a research topic as discovered.
+	bool discover(ResearchProgress *progress, int index) const;
+};
+
+}
@@ -27,7 +27,7 @@ namespace OpenXcom
  * type of base facility.
  * @param type String defining the type.
  */
-RuleBaseFacility::RuleBaseFacility(const std::string &type) : _type(type), _spriteShape(-1), _spriteFacility(-1), _lift(false), _hyper(false), _mind(false), _grav(false), _size(1), _buildCost(0), _buildTime(0), _monthlyCost(0), _storage(0), _personnel(0), _aliens(0), _crafts(0), _labs(0), _workshops(0), _psiLabs(0), _radarRange(0), _radarChance(0), _defense(0), _hitRatio(0), _fireSound(0), _hitSound(0), _listOrder(0)
+RuleBaseFacility::RuleBaseFacility(const std::string &type) : _type(type), _spriteShape(-1), _spriteFacility(-1), _lift(false), _hyper(false), _mind(false), _grav(false), _size(1), _buildCost(0), _buildTime(0), _monthlyCost(0), _storage(0), _personnel(0), _aliens(0), _crafts(0), _labs(0), _workshops(0), _psiLabs(0), _radarRange(0), _radarChance(0), _defense(0), _hitRatio(0), _fireSound(0), _hitSound(0), _listOrder(0), _index(-1)
 {
 }
 
@@ -358,4 +358,23 @@ int RuleBaseFacility::getListOrder() const
 	return _listOrder;
 }
 
+/**
+ * Gets the facility's index among all facility types,
+ * as taken by Mod::getBaseFacilityByIndex.
+ * @return The index, or -1 if not indexed.
+ */
+int RuleBaseFacility::getIndex() const
+{
+	return _index;
+}
+
+/**
+ * Sets the dense index assigned to this facility.
+ * @param index The index.
+ */
+void RuleBaseFacility::setIndex(int index)
+{
+	_index = index;
+}
+
 }
@@ -28,7 +28,7 @@ namespace OpenXcom
  * type of craft.
  * @param type String defining the type.
  */
-RuleCraft::RuleCraft(const std::string &type) : _type(type), _sprite(-1), _marker(-1), _fuelMax(0), _damageMax(0), _speedMax(0), _accel(0), _weapons(0), _soldiers(0), _vehicles(0), _costBuy(0), _costRent(0), _costSell(0), _repairRate(1), _refuelRate(1), _radarRange(672), _radarChance(100), _sightRange(1696), _transferTime(0), _score(0), _battlescapeTerrainData(0), _spacecraft(false), _listOrder(0), _maxItems(0), _maxAltitude(-1)
+RuleCraft::RuleCraft(const std::string &type) : _type(type), _sprite(-1), _marker(-1), _fuelMax(0), _damageMax(0), _speedMax(0), _accel(0), _weapons(0), _soldiers(0), _vehicles(0), _costBuy(0), _costRent(0), _costSell(0), _repairRate(1), _refuelRate(1), _radarRange(672), _radarChance(100), _sightRange(1696), _transferTime(0), _score(0), _battlescapeTerrainData(0), _spacecraft(false), _listOrder(0), _index(-1), _maxItems(0), _maxAltitude(-1)
 {
 
 }
@@ -329,6 +329,25 @@ int RuleCraft::getListOrder() const
 	 return _listOrder;
 }
 
+/**
+ * Gets the craft's index among all craft types,
+ * as taken by Mod::getCraftByIndex.
+ * @return The index, or -1 if not indexed.
+ */
+int RuleCraft::getIndex() const
+{
+	return _index;
+}
+
+/**
+ * Sets the dense index assigned to this craft.
+ * @param index The index.
+ */
+void RuleCraft::setIndex(int index)
+{
+	_index = index;
+}
+
 /**
  * Gets the deployment layout for this craft.
  * @return The deployment layout.
@@ -44,7 +44,7 @@ private:
 	int _repairRate, _refuelRate, _radarRange, _radarChance, _sightRange, _transferTime, _score;
 	RuleTerrain *_battlescapeTerrainData;
 	bool _spacecraft;
-	int _listOrder, _maxItems, _maxAltitude;
+	int _listOrder, _index, _maxItems, _maxAltitude;
 	std::vector<std::vector <int> > _deployment;
 public:
 	/// Creates a blank craft ruleset.
@@ -103,6 +103,10 @@ public:
 	bool getSpacecraft() const;
 	/// Gets the list weight for this craft.
 	int getListOrder() const;
+	/// Gets the craft's runtime index.
+	int getIndex() const;
+	/// Sets the craft's runtime index.
+	void setIndex(int index);
 	/// Gets the deployment priority for the craft.
 	std::vector<std::vector<int> > &getDeployment();
 	/// Gets the item limit for this craft.
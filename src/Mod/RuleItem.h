@@ -63,7 +63,7 @@ private:
 	bool _recover, _liveAlien;
 	int _blastRadius, _attraction;
 	bool _flatRate, _arcingShot;
-	int _listOrder, _maxRange, _aimRange, _snapRange, _autoRange, _minRange, _dropoff, _bulletSpeed, _explosionSpeed, _autoShots, _shotgunPellets;
+	int _listOrder, _index, _maxRange, _aimRange, _snapRange, _autoRange, _minRange, _dropoff, _bulletSpeed, _explosionSpeed, _autoShots, _shotgunPellets;
 	std::string _zombieUnit;
 	bool _strengthApplied, _skillApplied, _LOSRequired, _underwaterOnly, _landOnly;
 	int _meleeSound, _meleePower, _meleeAnimation, _meleeHitSound, _specialType, _vaporColor, _vaporDensity, _vaporProbability;
@@ -178,6 +178,10 @@ public:
 	int getAttraction() const;
 	/// Get the list weight for this item.
 	int getListOrder() const;
+	/// Gets the item's runtime index.
+	int getIndex() const;
+	/// Sets the item's runtime index.
+	void setIndex(int index);
 	/// How fast does a projectile fired from this weapon travel?
 	int getBulletSpeed() const;
 	/// How fast does the explosion animation play?
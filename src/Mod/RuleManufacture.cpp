@@ -24,7 +24,7 @@ namespace OpenXcom
  * Creates a new Manufacture.
  * @param name The unique manufacture name.
  */
-RuleManufacture::RuleManufacture(const std::string &name) : _name(name), _space(0), _time(0), _cost(0), _listOrder(0)
+RuleManufacture::RuleManufacture(const std::string &name) : _name(name), _space(0), _time(0), _cost(0), _listOrder(0), _index(-1)
 {
 	_producedItems[name] = 1;
 }
@@ -141,4 +141,23 @@ int RuleManufacture::getListOrder() const
 	return _listOrder;
 }
 
+/**
+ * Gets the project's index among all manufacture, which the
+ * research graph lists the projects a topic unlocks by.
+ * @return The index, or -1 if not indexed.
+ */
+int RuleManufacture::getIndex() const
+{
+	return _index;
+}
+
+/**
+ * Sets the dense index assigned to this manufacture project.
+ * @param index The index.
+ */
+void RuleManufacture::setIndex(int index)
+{
+	_index = index;
+}
+
 }
@@ -34,7 +34,7 @@ private:
 	std::vector<std::string> _requires;
 	int _space, _time, _cost;
 	std::map<std::string, int> _requiredItems, _producedItems;
-	int _listOrder;
+	int _listOrder, _index;
 public:
 	/// Creates a new manufacture.
 	RuleManufacture(const std::string &name);
@@ -59,6 +59,10 @@ public:
 	const std::map<std::string, int> & getProducedItems() const;
 	/// Gets the list weight for this manufacture item.
 	int getListOrder() const;
+	/// Gets the manufacture project's runtime index.
+	int getIndex() const;
+	/// Sets the manufacture project's runtime index.
+	void setIndex(int index);
 };
 
 }
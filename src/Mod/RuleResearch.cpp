@@ -22,7 +22,7 @@
 namespace OpenXcom
 {
 
-RuleResearch::RuleResearch(const std::string & name) : _name(name), _cost(0), _points(0), _needItem(false), _destroyItem(false), _listOrder(0)
+RuleResearch::RuleResearch(const std::string & name) : _name(name), _cost(0), _points(0), _needItem(false), _destroyItem(false), _listOrder(0), _index(-1)
 {
 }
 
@@ -154,6 +154,25 @@ int RuleResearch::getListOrder() const
 	return _listOrder;
 }
 
+/**
+ * Gets the project's index among all research, which the
+ * research graph and the saved research progress are addressed by.
+ * @return The index, or -1 if not indexed.
+ */
+int RuleResearch::getIndex() const
+{
+	return _index;
+}
+
+/**
+ * Sets the dense index assigned to this research project.
+ * @param index The index.
+ */
+void RuleResearch::setIndex(int index)
+{
+	_index = index;
+}
+
 /**
  * Gets the cutscene to play when this research item is completed.
  * @return The cutscene id.
@@ -42,7 +42,7 @@ class RuleResearch
 	int _cost, _points;
 	std::vector<std::string> _dependencies, _unlocks, _getOneFree, _requires;
 	bool _needItem, _destroyItem;
-	int _listOrder;
+	int _listOrder, _index;
 public:
 	RuleResearch(const std::string & name);
 	/// Loads the research from YAML.
@@ -69,6 +69,10 @@ public:
 	const std::vector<std::string> & getRequirements() const;
 	/// Gets the list weight for this research item.
 	int getListOrder() const;
+	/// Gets the research project's runtime index.
+	int getIndex() const;
+	/// Sets the research project's runtime index.
+	void setIndex(int index);
 	/// Gets the cutscene to play when this item is researched
 	const std::string & getCutscene() const;
 };
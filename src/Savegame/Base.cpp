@@ -54,7 +54,7 @@ namespace OpenXcom
  */
 Base::Base(const Mod *mod) : Target(), _mod(mod), _scientists(0), _engineers(0), _inBattlescape(false), _retaliationTarget(false)
 {
-	_items = new ItemContainer();
+	_items = new ItemContainer(mod);
 }
 
 /**
@@ -170,16 +170,14 @@ void Base::load(const YAML::Node &node, SavedGame *save, bool newGame, bool newB
 
 	_items->load(node["items"]);
 	// Some old saves have bad items, better get rid of them to avoid further bugs
-	for (std::map<std::string, int>::iterator i = _items->getContents()->begin(); i != _items->getContents()->end();)
+	// (only items stored by type can be unknown to the mod)
+	std::map<std::string, int> contents = _items->getUnindexedItems();
+	for (std::map<std::string, int>::iterator i = contents.begin(); i != contents.end(); ++i)
 	{
 		if (_mod->getItem(i->first) == 0)
 		{
 			Log(LOG_ERROR) << "Failed to load item " << i->first;
-			_items->getContents()->erase(i++);
-		}
-		else
-		{
-			++i;
+			_items->removeItem(i->first, i->second);
 		}
 	}
 
@@ -354,6 +352,15 @@ ItemContainer *Base::getStorageItems()
 	return _items;
 }
 
+/**
+ * Returns the mod the base's contents belong to.
+ * @return Pointer to mod.
+ */
+const Mod *Base::getMod() const
+{
+	return _mod;
+}
+
 /**
  * Returns the amount of scientists currently in the base.
  * @return Number of scientists.
@@ -469,7 +476,7 @@ int Base::getAvailableSoldiers(bool checkCombatReadiness) const
 		{
 			total++;
 		}
-		else if (checkCombatReadiness && (((*i)->getCraft() != 0 && (*i)->getCraft()->getStatus() != "STR_OUT") ||
+		else if (checkCombatReadiness && (((*i)->getCraft() != 0 && (*i)->getCraft()->getStatus() != Craft::STATUS_OUT) ||
 			((*i)->getCraft() == 0 && (*i)->getWoundRecovery() == 0)))
 		{
 			total++;
@@ -666,7 +673,7 @@ double Base::getIgnoredStores()
 	double space = 0;
 	for (std::vector<Craft*>::iterator c = getCrafts()->begin(); c != getCrafts()->end(); ++c)
 	{
-		if ((*c)->getStatus() == "STR_REARMING")
+		if ((*c)->getStatus() == Craft::STATUS_REARMING)
 		{
 			for (std::vector<CraftWeapon*>::iterator w = (*c)->getWeapons()->begin(); w != (*c)->getWeapons()->end() ; ++w)
 			{
@@ -1183,11 +1190,20 @@ int Base::getUsedPsiLabs() const
 int Base::getUsedContainment() const
 {
 	int total = 0;
-	for (std::map<std::string, int>::iterator i = _items->getContents()->begin(); i != _items->getContents()->end(); ++i)
+	for (size_t i = 0; i != _items->getIndexedCount(); ++i)
+	{
+		int qty = _items->getIndexedItem(i);
+		if (qty != 0 && _mod->getItemByIndex(i)->isAlien())
+		{
+			total += qty;
+		}
+	}
+	const std::map<std::string, int> &unindexed = _items->getUnindexedItems();
+	for (std::map<std::string, int>::const_iterator i = unindexed.begin(); i != unindexed.end(); ++i)
 	{
-		if (_mod->getItem((i)->first, true)->isAlien())
+		if (_mod->getItem(i->first, true)->isAlien())
 		{
-			total += (i)->second;
+			total += i->second;
 		}
 	}
 	for (std::vector<Transfer*>::const_iterator i = _transfers.begin(); i != _transfers.end(); ++i)
@@ -1366,7 +1382,7 @@ void Base::setupDefenses()
 	// add vehicles that are in the crafts of the base, if it's not out
 	for (std::vector<Craft*>::iterator c = getCrafts()->begin(); c != getCrafts()->end(); ++c)
 	{
-		if ((*c)->getStatus() != "STR_OUT")
+		if ((*c)->getStatus() != Craft::STATUS_OUT)
 		{
 			for (std::vector<Vehicle*>::iterator i = (*c)->getVehicles()->begin(); i != (*c)->getVehicles()->end(); ++i)
 			{
@@ -1376,58 +1392,68 @@ void Base::setupDefenses()
 	}
 
 	// add vehicles left on the base
-	for (std::map<std::string, int>::iterator i = _items->getContents()->begin(); i != _items->getContents()->end(); )
+	std::vector<RuleItem*> fixed;
+	for (size_t i = 0; i != _items->getIndexedCount(); ++i)
 	{
-		std::string itemId = (i)->first;
-		int itemQty = (i)->second;
-		RuleItem *rule = _mod->getItem(itemId, true);
+		if (_items->getIndexedItem(i) != 0 && _mod->getItemByIndex(i)->isFixed())
+		{
+			fixed.push_back(_mod->getItemByIndex(i));
+		}
+	}
+	const std::map<std::string, int> &unindexed = _items->getUnindexedItems();
+	for (std::map<std::string, int>::const_iterator i = unindexed.begin(); i != unindexed.end(); ++i)
+	{
+		RuleItem *rule = _mod->getItem(i->first, true);
 		if (rule->isFixed())
 		{
-			int size = 4;
-			if (_mod->getUnit(itemId))
+			fixed.push_back(rule);
+		}
+	}
+	for (std::vector<RuleItem*>::iterator i = fixed.begin(); i != fixed.end(); ++i)
+	{
+		RuleItem *rule = *i;
+		const std::string &itemId = rule->getType();
+		int itemQty = _items->getItem(rule);
+		int size = 4;
+		if (_mod->getUnit(itemId))
+		{
+			size = _mod->getArmor(_mod->getUnit(itemId)->getArmor(), true)->getSize();
+		}
+		if (rule->getCompatibleAmmo()->empty()) // so this vehicle does not need ammo
+		{
+			for (int j = 0; j < itemQty; ++j)
+			{
+				_vehicles.push_back(new Vehicle(rule, rule->getClipSize(), size));
+			}
+			_items->removeItem(itemId, itemQty);
+		}
+		else // so this vehicle needs ammo
+		{
+			RuleItem *ammo = _mod->getItem(rule->getCompatibleAmmo()->front(), true);
+			int ammoPerVehicle, clipSize;
+			if (ammo->getClipSize() > 0 && rule->getClipSize() > 0)
 			{
-				size = _mod->getArmor(_mod->getUnit(itemId)->getArmor(), true)->getSize();
+				clipSize = rule->getClipSize();
+				ammoPerVehicle = clipSize / ammo->getClipSize();
 			}
-			if (rule->getCompatibleAmmo()->empty()) // so this vehicle does not need ammo
+			else
 			{
-				for (int j = 0; j < itemQty; ++j)
-				{
-					_vehicles.push_back(new Vehicle(rule, rule->getClipSize(), size));
-				}
-				_items->removeItem(itemId, itemQty);
+				clipSize = ammo->getClipSize();
+				ammoPerVehicle = clipSize;
 			}
-			else // so this vehicle needs ammo
+			int baseQty = _items->getItem(ammo) / ammoPerVehicle;
+			if (!baseQty)
 			{
-				RuleItem *ammo = _mod->getItem(rule->getCompatibleAmmo()->front(), true);
-				int ammoPerVehicle, clipSize;
-				if (ammo->getClipSize() > 0 && rule->getClipSize() > 0)
-				{
-					clipSize = rule->getClipSize();
-					ammoPerVehicle = clipSize / ammo->getClipSize();
-				}
-				else
-				{
-					clipSize = ammo->getClipSize();
-					ammoPerVehicle = clipSize;
-				}
-				int baseQty = _items->getItem(ammo->getType()) / ammoPerVehicle;
-				if (!baseQty)
-				{
-					++i;
-					continue;
-				}
-				int canBeAdded = std::min(itemQty, baseQty);
-				for (int j=0; j<canBeAdded; ++j)
-				{
-					_vehicles.push_back(new Vehicle(rule, clipSize, size));
-					_items->removeItem(ammo->getType(), ammoPerVehicle);
-				}
-				_items->removeItem(itemId, canBeAdded);
+				continue;
 			}
-
-			i = _items->getContents()->begin(); // we have to start over because iterator is broken because of the removeItem
+			int canBeAdded = std::min(itemQty, baseQty);
+			for (int j=0; j<canBeAdded; ++j)
+			{
+				_vehicles.push_back(new Vehicle(rule, clipSize, size));
+				_items->removeItem(ammo, ammoPerVehicle);
+			}
+			_items->removeItem(rule, canBeAdded);
 		}
-		else ++i;
 	}
 }
 
@@ -1572,12 +1598,8 @@ void Base::destroyFacility(std::vector<BaseFacility*>::iterator facility)
 				}
 			}
 			// remove all items
-			while (!(*facility)->getCraft()->getItems()->getContents()->empty())
-			{
-				std::map<std::string, int>::iterator i = (*facility)->getCraft()->getItems()->getContents()->begin();
-				_items->addItem(i->first, i->second);
-				(*facility)->getCraft()->getItems()->removeItem(i->first, i->second);
-			}
+			_items->merge(*(*facility)->getCraft()->getItems());
+			(*facility)->getCraft()->getItems()->clear();
 			for (std::vector<Craft*>::iterator i = _crafts.begin(); i != _crafts.end(); ++i)
 			{
 				if (*i == (*facility)->getCraft())
@@ -91,6 +91,8 @@ public:
 	std::vector<Transfer*> *getTransfers();
 	/// Gets the base's items.
 	ItemContainer *getStorageItems();
+	/// Gets the base's mod.
+	const Mod *getMod() const;
 	/// Gets the base's scientists.
 	int getScientists() const;
 	/// Sets the base's scientists.
@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <yaml-cpp/yaml.h>
+#include "../Engine/MemoryPool.h"
 
 namespace OpenXcom
 {
@@ -33,7 +34,7 @@ class Tile;
  * @sa RuleItem
  * @sa Item
  */
-class BattleItem
+class BattleItem : public PooledObject<BattleItem>
 {
 private:
 	int _id;
@@ -294,8 +294,6 @@ BattleUnit::BattleUnit(Unit *unit, UnitFaction faction, int id, Armor *armor, St
  */
 BattleUnit::~BattleUnit()
 {
-	for (int i = 0; i < 5; ++i)
-		if (_cache[i]) delete _cache[i];
 	for (std::vector<BattleUnitKills*>::const_iterator i = _statistics->kills.begin(); i != _statistics->kills.end(); ++i)
 	{
 		delete *i;
@@ -898,7 +896,8 @@ UnitFaction BattleUnit::getFaction() const
 }
 
 /**
- * Sets the unit's cache flag.
+ * Sets the unit's cache flag. The cache surfaces are owned
+ * and shared between units by the Map.
  * @param cache Pointer to cache surface to use, NULL to redraw from scratch.
  * @param part Unit part to cache.
  */
@@ -1639,6 +1638,7 @@ void BattleUnit::prepareNewTurn(bool fullProcess)
 	if (_faction != _originalFaction)
 	{
 		_faction = _originalFaction;
+		Tile::touchOccupants();
 	}
 	else
 	{
@@ -2625,6 +2625,8 @@ std::string BattleUnit::getActiveHand() const
 void BattleUnit::convertToFaction(UnitFaction f)
 {
 	_faction = f;
+	// paths around the unit depend on which side it's on
+	Tile::touchOccupants();
 }
 
 /**
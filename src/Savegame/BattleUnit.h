@@ -27,6 +27,7 @@
 #include "../Mod/MapData.h"
 #include "Soldier.h"
 #include "BattleItem.h"
+#include "../Engine/MemoryPool.h"
 
 namespace OpenXcom
 {
@@ -56,7 +57,7 @@ enum UnitBodyPart {BODYPART_HEAD, BODYPART_TORSO, BODYPART_RIGHTARM, BODYPART_LE
  * Represents a moving unit in the battlescape, player controlled or AI controlled
  * it holds info about it's position, items carrying, stats, etc
  */
-class BattleUnit
+class BattleUnit : public PooledObject<BattleUnit>
 {
 private:
 	static const int SPEC_WEAPON_MAX = 3;
@@ -40,6 +40,9 @@
 namespace OpenXcom
 {
 
+/// String IDs of each craft status, as stored in saves and shown on screen.
+static const char *craftStatusNames[] = { "STR_READY", "STR_OUT", "STR_REPAIRS", "STR_REFUELLING", "STR_REARMING" };
+
 /**
  * Initializes a craft of the specified type and
  * assigns it the latest craft ID available.
@@ -47,9 +50,9 @@ namespace OpenXcom
  * @param base Pointer to base of origin.
  * @param id ID to assign to the craft (0 to not assign).
  */
-Craft::Craft(RuleCraft *rules, Base *base, int id) : MovingTarget(), _rules(rules), _base(base), _id(0), _fuel(0), _damage(0), _interceptionOrder(0), _takeoff(0), _status("STR_READY"), _lowFuel(false), _mission(false), _inBattlescape(false), _inDogfight(false)
+Craft::Craft(RuleCraft *rules, Base *base, int id) : MovingTarget(), _rules(rules), _base(base), _id(0), _fuel(0), _damage(0), _interceptionOrder(0), _takeoff(0), _status(STATUS_READY), _lowFuel(false), _mission(false), _inBattlescape(false), _inDogfight(false)
 {
-	_items = new ItemContainer();
+	_items = new ItemContainer(base != 0 ? base->getMod() : 0);
 	if (id != 0)
 	{
 		_id = id;
@@ -119,16 +122,14 @@ void Craft::load(const YAML::Node &node, const Mod *mod, SavedGame *save)
 
 	_items->load(node["items"]);
 	// Some old saves have bad items, better get rid of them to avoid further bugs
-	for (std::map<std::string, int>::iterator i = _items->getContents()->begin(); i != _items->getContents()->end();)
+	// (only items stored by type can be unknown to the mod)
+	std::map<std::string, int> contents = _items->getUnindexedItems();
+	for (std::map<std::string, int>::iterator i = contents.begin(); i != contents.end(); ++i)
 	{
 		if (mod->getItem(i->first) == 0)
 		{
 			Log(LOG_ERROR) << "Failed to load item " << i->first;
-			_items->getContents()->erase(i++);
-		}
-		else
-		{
-			++i;
+			_items->removeItem(i->first, i->second);
 		}
 	}
 	for (YAML::const_iterator i = node["vehicles"].begin(); i != node["vehicles"].end(); ++i)
@@ -145,7 +146,21 @@ void Craft::load(const YAML::Node &node, const Mod *mod, SavedGame *save)
 			Log(LOG_ERROR) << "Failed to load item " << type;
 		}
 	}
-	_status = node["status"].as<std::string>(_status);
+	std::string status = node["status"].as<std::string>(getStatusString());
+	size_t statuses = sizeof(craftStatusNames) / sizeof(craftStatusNames[0]);
+	size_t i = 0;
+	while (i != statuses && status != craftStatusNames[i])
+	{
+		++i;
+	}
+	if (i != statuses)
+	{
+		_status = (CraftStatus)i;
+	}
+	else
+	{
+		Log(LOG_WARNING) << "Unknown craft status " << status << ", using " << getStatusString();
+	}
 	_lowFuel = node["lowFuel"].as<bool>(_lowFuel);
 	_mission = node["mission"].as<bool>(_mission);
 	_interceptionOrder = node["interceptionOrder"].as<int>(_interceptionOrder);
@@ -238,7 +253,7 @@ YAML::Node Craft::save() const
 	{
 		node["vehicles"].push_back((*i)->save());
 	}
-	node["status"] = _status;
+	node["status"] = getStatusString();
 	if (_lowFuel)
 		node["lowFuel"] = _lowFuel;
 	if (_mission)
@@ -325,7 +340,7 @@ std::wstring Craft::getDefaultName(Language *lang) const
  */
 int Craft::getMarker() const
 {
-	if (_status != "STR_OUT")
+	if (_status != STATUS_OUT)
 		return -1;
 	else if (_rules->getMarker() == -1)
 		return 1;
@@ -358,18 +373,39 @@ void Craft::setBase(Base *base, bool move)
 
 /**
  * Returns the current status of the craft.
- * @return Status string.
+ * @return Status ID.
  */
-std::string Craft::getStatus() const
+Craft::CraftStatus Craft::getStatus() const
 {
 	return _status;
 }
 
+/**
+ * Returns the string ID of the current status of the craft,
+ * for displaying or saving.
+ * @return Status string.
+ */
+std::string Craft::getStatusString() const
+{
+	return getStatusString(_status);
+}
+
+/**
+ * Returns the string ID of a craft status,
+ * as stored in saves and shown on screen.
+ * @param status Status ID.
+ * @return Status string.
+ */
+std::string Craft::getStatusString(CraftStatus status)
+{
+	return craftStatusNames[status];
+}
+
 /**
  * Changes the current status of the craft.
- * @param status Status string.
+ * @param status Status ID.
  */
-void Craft::setStatus(const std::string &status)
+void Craft::setStatus(CraftStatus status)
 {
 	_status = status;
 }
@@ -398,7 +434,7 @@ std::string Craft::getAltitude() const
  */
 void Craft::setDestination(Target *dest)
 {
-	if (_status != "STR_OUT")
+	if (_status != STATUS_OUT)
 	{
 		_takeoff = 60;
 	}
@@ -715,15 +751,15 @@ void Craft::checkup()
 
 	if (_damage > 0)
 	{
-		_status = "STR_REPAIRS";
+		_status = STATUS_REPAIRS;
 	}
 	else if (available != full)
 	{
-		_status = "STR_REARMING";
+		_status = STATUS_REARMING;
 	}
 	else
 	{
-		_status = "STR_REFUELLING";
+		_status = STATUS_REFUELLING;
 	}
 }
 
@@ -777,7 +813,7 @@ void Craft::repair()
 	setDamage(_damage - _rules->getRepairRate());
 	if (_damage <= 0)
 	{
-		_status = "STR_REARMING";
+		_status = STATUS_REARMING;
 	}
 }
 
@@ -790,12 +826,12 @@ void Craft::refuel()
 	setFuel(_fuel + _rules->getRefuelRate());
 	if (_fuel >= _rules->getMaxFuel())
 	{
-		_status = "STR_READY";
+		_status = STATUS_READY;
 		for (std::vector<CraftWeapon*>::iterator i = _weapons.begin(); i != _weapons.end(); ++i)
 		{
 			if (*i && (*i)->isRearming())
 			{
-				_status = "STR_REARMING";
+				_status = STATUS_REARMING;
 				break;
 			}
 		}
@@ -815,7 +851,7 @@ std::string Craft::rearm(const Mod *mod)
 	{
 		if (i == _weapons.end())
 		{
-			_status = "STR_REFUELLING";
+			_status = STATUS_REFUELLING;
 			break;
 		}
 		if (*i != 0 && (*i)->isRearming())
@@ -987,10 +1023,7 @@ void Craft::unload(const Mod *mod)
 	}
 
 	// Remove items
-	for (std::map<std::string, int>::iterator it = _items->getContents()->begin(); it != _items->getContents()->end(); ++it)
-	{
-		_base->getStorageItems()->addItem(it->first, it->second);
-	}
+	_base->getStorageItems()->merge(*_items);
 
 	// Remove vehicles
 	for (std::vector<Vehicle*>::iterator v = _vehicles.begin(); v != _vehicles.end(); ++v)
@@ -1019,7 +1052,7 @@ void Craft::unload(const Mod *mod)
  */
 void Craft::reuseItem(const std::string& item)
 {
-	if (_status != "STR_READY")
+	if (_status != STATUS_READY)
 		return;
 	// Check if it's ammo to reload the craft
 	for (std::vector<CraftWeapon*>::iterator w = _weapons.begin(); w != _weapons.end(); ++w)
@@ -1027,12 +1060,12 @@ void Craft::reuseItem(const std::string& item)
 		if ((*w) != 0 && item == (*w)->getRules()->getClipItem() && (*w)->getAmmo() < (*w)->getRules()->getAmmoMax())
 		{
 			(*w)->setRearming(true);
-			_status = "STR_REARMING";
+			_status = STATUS_REARMING;
 		}
 	}
 	// Check if it's fuel to refuel the craft
 	if (item == _rules->getRefuelItem() && _fuel < _rules->getMaxFuel())
-		_status = "STR_REFUELLING";
+		_status = STATUS_REFUELLING;
 }
 
 }
@@ -44,6 +44,8 @@ class Vehicle;
  */
 class Craft : public MovingTarget
 {
+public:
+	enum CraftStatus { STATUS_READY, STATUS_OUT, STATUS_REPAIRS, STATUS_REFUELLING, STATUS_REARMING };
 private:
 	RuleCraft *_rules;
 	Base *_base;
@@ -51,7 +53,7 @@ private:
 	std::vector<CraftWeapon*> _weapons;
 	ItemContainer *_items;
 	std::vector<Vehicle*> _vehicles;
-	std::string _status;
+	CraftStatus _status;
 	bool _lowFuel, _mission, _inBattlescape, _inDogfight;
 
 	using MovingTarget::load;
@@ -83,9 +85,13 @@ public:
 	/// Sets the craft's base.
 	void setBase(Base *base, bool move = true);
 	/// Gets the craft's status.
-	std::string getStatus() const;
+	CraftStatus getStatus() const;
+	/// Gets the craft's status string ID.
+	std::string getStatusString() const;
+	/// Gets the string ID of a craft status.
+	static std::string getStatusString(CraftStatus status);
 	/// Sets the craft's status.
-	void setStatus(const std::string &status);
+	void setStatus(CraftStatus status);
 	/// Gets the craft's altitude.
 	std::string getAltitude() const;
 	/// Sets the craft's destination.
@@ -17,6 +17,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "ItemContainer.h"
+#include <algorithm>
 #include "../Mod/Mod.h"
 #include "../Mod/RuleItem.h"
 
@@ -25,9 +26,15 @@ namespace OpenXcom
 
 /**
  * Initializes an item container with no contents.
+ * @param mod Pointer to mod, used to store the items
+ * by index. If NULL, they are stored by type only.
  */
-ItemContainer::ItemContainer()
+ItemContainer::ItemContainer(const Mod *mod) : _mod(mod), _totalQuantity(0), _totalSize(0.0), _totalSizeValid(true)
 {
+	if (_mod != 0 && _mod->getItemsList().size() <= MAX_DENSE_ITEMS)
+	{
+		_dense.resize(_mod->getItemsList().size(), 0);
+	}
 }
 
 /**
@@ -37,13 +44,48 @@ ItemContainer::~ItemContainer()
 {
 }
 
+/**
+ * Returns the position of an item in the flat array.
+ * @param rule Item ruleset.
+ * @return Array index, or -1 if the item is stored by type.
+ */
+int ItemContainer::getDenseIndex(const RuleItem *rule) const
+{
+	if (rule == 0 || _dense.empty())
+	{
+		return -1;
+	}
+	int index = rule->getIndex();
+	if (index < 0 || index >= (int)_dense.size())
+	{
+		return -1;
+	}
+	return index;
+}
+
+/**
+ * Checks if another container keeps its items in a flat array
+ * laid out the same way, so the two can be combined index by index.
+ * @param other Other container.
+ * @return True if the arrays line up.
+ */
+bool ItemContainer::sameLayout(const ItemContainer &other) const
+{
+	return _mod == other._mod && _dense.size() == other._dense.size();
+}
+
 /**
  * Loads the item container from a YAML file.
  * @param node YAML node.
  */
 void ItemContainer::load(const YAML::Node &node)
 {
-	_qty = node.as< std::map<std::string, int> >(_qty);
+	std::map<std::string, int> qty = node.as< std::map<std::string, int> >(getContents());
+	clear();
+	for (std::map<std::string, int>::const_iterator i = qty.begin(); i != qty.end(); ++i)
+	{
+		addItem(i->first, i->second);
+	}
 }
 
 /**
@@ -53,7 +95,7 @@ void ItemContainer::load(const YAML::Node &node)
 YAML::Node ItemContainer::save() const
 {
 	YAML::Node node;
-	node = _qty;
+	node = getContents();
 	return node;
 }
 
@@ -68,11 +110,45 @@ void ItemContainer::addItem(const std::string &id, int qty)
 	{
 		return;
 	}
+	if (!_dense.empty())
+	{
+		int index = getDenseIndex(_mod->getItem(id));
+		if (index != -1)
+		{
+			_dense[index] += qty;
+			_totalQuantity += qty;
+			_totalSizeValid = false;
+			return;
+		}
+	}
 	if (_qty.find(id) == _qty.end())
 	{
 		_qty[id] = 0;
 	}
 	_qty[id] += qty;
+	_totalQuantity += qty;
+	_totalSizeValid = false;
+}
+
+/**
+ * Adds an item amount to the container.
+ * @param rule Item ruleset.
+ * @param qty Item quantity.
+ */
+void ItemContainer::addItem(const RuleItem *rule, int qty)
+{
+	int index = getDenseIndex(rule);
+	if (index == -1)
+	{
+		if (rule != 0)
+		{
+			addItem(rule->getType(), qty);
+		}
+		return;
+	}
+	_dense[index] += qty;
+	_totalQuantity += qty;
+	_totalSizeValid = false;
 }
 
 /**
@@ -82,18 +158,60 @@ void ItemContainer::addItem(const std::string &id, int qty)
  */
 void ItemContainer::removeItem(const std::string &id, int qty)
 {
-	if (id.empty() || _qty.find(id) == _qty.end())
+	if (id.empty())
+	{
+		return;
+	}
+	if (!_dense.empty())
+	{
+		int index = getDenseIndex(_mod->getItem(id));
+		if (index != -1)
+		{
+			int removed = std::min(qty, _dense[index]);
+			_dense[index] -= removed;
+			_totalQuantity -= removed;
+			_totalSizeValid = false;
+			return;
+		}
+	}
+	std::map<std::string, int>::iterator i = _qty.find(id);
+	if (i == _qty.end())
 	{
 		return;
 	}
-	if (qty < _qty[id])
+	if (qty < i->second)
 	{
-		_qty[id] -= qty;
+		i->second -= qty;
+		_totalQuantity -= qty;
 	}
 	else
 	{
-		_qty.erase(id);
+		_totalQuantity -= i->second;
+		_qty.erase(i);
+	}
+	_totalSizeValid = false;
+}
+
+/**
+ * Removes an item amount from the container.
+ * @param rule Item ruleset.
+ * @param qty Item quantity.
+ */
+void ItemContainer::removeItem(const RuleItem *rule, int qty)
+{
+	int index = getDenseIndex(rule);
+	if (index == -1)
+	{
+		if (rule != 0)
+		{
+			removeItem(rule->getType(), qty);
+		}
+		return;
 	}
+	int removed = std::min(qty, _dense[index]);
+	_dense[index] -= removed;
+	_totalQuantity -= removed;
+	_totalSizeValid = false;
 }
 
 /**
@@ -107,6 +225,14 @@ int ItemContainer::getItem(const std::string &id) const
 	{
 		return 0;
 	}
+	if (!_dense.empty())
+	{
+		int index = getDenseIndex(_mod->getItem(id));
+		if (index != -1)
+		{
+			return _dense[index];
+		}
+	}
 
 	std::map<std::string, int>::const_iterator it = _qty.find(id);
 	if (it == _qty.end())
@@ -119,42 +245,212 @@ int ItemContainer::getItem(const std::string &id) const
 	}
 }
 
+/**
+ * Returns the quantity of an item in the container.
+ * Faster than looking it up by type.
+ * @param rule Item ruleset.
+ * @return Item quantity.
+ */
+int ItemContainer::getItem(const RuleItem *rule) const
+{
+	int index = getDenseIndex(rule);
+	if (index == -1)
+	{
+		return rule != 0 ? getItem(rule->getType()) : 0;
+	}
+	return _dense[index];
+}
+
 /**
  * Returns the total quantity of the items in the container.
  * @return Total item quantity.
  */
 int ItemContainer::getTotalQuantity() const
 {
-	int total = 0;
-	for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
-	{
-		total += i->second;
-	}
-	return total;
+	return _totalQuantity;
 }
 
 /**
  * Returns the total size of the items in the container.
+ * The result is cached until the contents change.
  * @param mod Pointer to mod.
  * @return Total item size.
  */
 double ItemContainer::getTotalSize(const Mod *mod) const
 {
-	double total = 0;
-	for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
+	if (!_totalSizeValid)
 	{
-		total += mod->getItem(i->first, true)->getSize() * i->second;
+		double total = 0;
+		for (size_t i = 0; i != _dense.size(); ++i)
+		{
+			if (_dense[i] != 0)
+			{
+				total += _mod->getItemByIndex(i)->getSize() * _dense[i];
+			}
+		}
+		for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
+		{
+			total += mod->getItem(i->first, true)->getSize() * i->second;
+		}
+		_totalSize = total;
+		_totalSizeValid = true;
 	}
-	return total;
+	return _totalSize;
 }
 
 /**
  * Returns all the items currently contained within.
- * @return List of contents.
+ * @return Copy of the contents, by item ID.
+ */
+std::map<std::string, int> ItemContainer::getContents() const
+{
+	std::map<std::string, int> contents = _qty;
+	for (size_t i = 0; i != _dense.size(); ++i)
+	{
+		if (_dense[i] != 0)
+		{
+			contents[_mod->getItemByIndex(i)->getType()] = _dense[i];
+		}
+	}
+	return contents;
+}
+
+/**
+ * Returns how many items are kept in the flat array, to go
+ * through the contents without copying them into a map.
+ * Indices with a zero quantity aren't in the container.
+ * @return Number of indices, 0 if everything is stored by type.
+ * @sa getUnindexedItems
+ */
+size_t ItemContainer::getIndexedCount() const
+{
+	return _dense.size();
+}
+
+/**
+ * Returns the quantity of the item with a given index,
+ * the same one Mod::getItemByIndex takes.
+ * @param index Item index, below getIndexedCount().
+ * @return Item quantity.
+ */
+int ItemContainer::getIndexedItem(size_t index) const
+{
+	return _dense[index];
+}
+
+/**
+ * Returns the items kept by type, either because the mod
+ * doesn't know them or because it has too many items to index.
+ * @return Quantities, by item ID.
+ */
+const std::map<std::string, int> &ItemContainer::getUnindexedItems() const
+{
+	return _qty;
+}
+
+/**
+ * Removes all the items currently contained within.
+ */
+void ItemContainer::clear()
+{
+	std::fill(_dense.begin(), _dense.end(), 0);
+	_qty.clear();
+	_totalQuantity = 0;
+	_totalSize = 0.0;
+	_totalSizeValid = true;
+}
+
+/**
+ * Adds all the items of another container to this one,
+ * eg. when unloading a craft into the base stores.
+ * @param other Container to add from.
+ */
+void ItemContainer::merge(const ItemContainer &other)
+{
+	if (sameLayout(other))
+	{
+		for (size_t i = 0; i != _dense.size(); ++i)
+		{
+			_dense[i] += other._dense[i];
+			_totalQuantity += other._dense[i];
+		}
+		for (std::map<std::string, int>::const_iterator i = other._qty.begin(); i != other._qty.end(); ++i)
+		{
+			addItem(i->first, i->second);
+		}
+		_totalSizeValid = false;
+	}
+	else
+	{
+		for (size_t i = 0; i != other._dense.size(); ++i)
+		{
+			if (other._dense[i] != 0)
+			{
+				addItem(other._mod->getItemByIndex(i)->getType(), other._dense[i]);
+			}
+		}
+		for (std::map<std::string, int>::const_iterator i = other._qty.begin(); i != other._qty.end(); ++i)
+		{
+			addItem(i->first, i->second);
+		}
+	}
+}
+
+/**
+ * Removes an item amount, noting down how many short the container was.
+ * @param id Item ID.
+ * @param qty Item quantity.
+ * @param missing Map to note the shortfall in.
  */
-std::map<std::string, int> *ItemContainer::getContents()
+void ItemContainer::subtractItem(const std::string &id, int qty, std::map<std::string, int> &missing)
 {
-	return &_qty;
+	int have = getItem(id);
+	if (have < qty)
+	{
+		missing[id] = qty - have;
+	}
+	removeItem(id, qty);
+}
+
+/**
+ * Removes all the items of another container from this one,
+ * as far as there are enough of them, eg. when re-equipping a craft
+ * from the base stores.
+ * @param other Container with the items to remove.
+ * @return The items that couldn't be removed, by item ID.
+ */
+std::map<std::string, int> ItemContainer::subtract(const ItemContainer &other)
+{
+	std::map<std::string, int> missing;
+	if (sameLayout(other))
+	{
+		for (size_t i = 0; i != _dense.size(); ++i)
+		{
+			if (other._dense[i] > _dense[i])
+			{
+				missing[_mod->getItemByIndex(i)->getType()] = other._dense[i] - _dense[i];
+			}
+			int removed = std::min(_dense[i], other._dense[i]);
+			_dense[i] -= removed;
+			_totalQuantity -= removed;
+		}
+		_totalSizeValid = false;
+	}
+	else
+	{
+		for (size_t i = 0; i != other._dense.size(); ++i)
+		{
+			if (other._dense[i] != 0)
+			{
+				subtractItem(other._mod->getItemByIndex(i)->getType(), other._dense[i], missing);
+			}
+		}
+	}
+	for (std::map<std::string, int>::const_iterator i = other._qty.begin(); i != other._qty.end(); ++i)
+	{
+		subtractItem(i->first, i->second, missing);
+	}
+	return missing;
 }
 
 }
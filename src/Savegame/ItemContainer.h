@@ -19,25 +19,43 @@
  */
 #include <string>
 #include <map>
+#include <vector>
 #include <yaml-cpp/yaml.h>
 
 namespace OpenXcom
 {
 
 class Mod;
+class RuleItem;
 
 /**
  * Represents the items contained by a certain entity,
  * like base stores, craft equipment, etc.
  * Handles all necessary item management tasks.
+ * When created with a mod, the quantities are kept in a
+ * flat array indexed by item index, with a map for items
+ * unknown to the mod (or all items, if there's too many).
  */
 class ItemContainer
 {
 private:
+	static const int MAX_DENSE_ITEMS = 4096;
+	const Mod *_mod;
+	std::vector<int> _dense;
 	std::map<std::string, int> _qty;
+	int _totalQuantity;
+	mutable double _totalSize;
+	mutable bool _totalSizeValid;
+
+	/// Gets the dense index of an item, or -1 if it's stored in the map.
+	int getDenseIndex(const RuleItem *rule) const;
+	/// Checks if another container stores its items at the same indices.
+	bool sameLayout(const ItemContainer &other) const;
+	/// Removes an item, noting how many were missing.
+	void subtractItem(const std::string &id, int qty, std::map<std::string, int> &missing);
 public:
 	/// Creates an empty item container.
-	ItemContainer();
+	ItemContainer(const Mod *mod = 0);
 	/// Cleans up the item container.
 	~ItemContainer();
 	/// Loads the item container from YAML.
@@ -46,16 +64,34 @@ public:
 	YAML::Node save() const;
 	/// Adds an item to the container.
 	void addItem(const std::string &id, int qty = 1);
+	/// Adds an item to the container.
+	void addItem(const RuleItem *rule, int qty = 1);
 	/// Removes an item from the container.
 	void removeItem(const std::string &id, int qty = 1);
+	/// Removes an item from the container.
+	void removeItem(const RuleItem *rule, int qty = 1);
 	/// Gets an item in the container.
 	int getItem(const std::string &id) const;
+	/// Gets an item in the container.
+	int getItem(const RuleItem *rule) const;
 	/// Gets the total quantity of items in the container.
 	int getTotalQuantity() const;
 	/// Gets the total size of items in the container.
 	double getTotalSize(const Mod *mod) const;
 	/// Gets all the items in the container.
-	std::map<std::string, int> *getContents();
+	std::map<std::string, int> getContents() const;
+	/// Gets the number of items stored by index.
+	size_t getIndexedCount() const;
+	/// Gets the quantity of the item with an index.
+	int getIndexedItem(size_t index) const;
+	/// Gets the items stored by type instead of by index.
+	const std::map<std::string, int> &getUnindexedItems() const;
+	/// Removes all the items from the container.
+	void clear();
+	/// Adds all the items of another container.
+	void merge(const ItemContainer &other);
+	/// Removes all the items of another container.
+	std::map<std::string, int> subtract(const ItemContainer &other);
 };
 
 }
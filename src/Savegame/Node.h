@@ -19,6 +19,7 @@
  */
 #include "../Battlescape/Position.h"
 #include <yaml-cpp/yaml.h>
+#include "../Engine/MemoryPool.h"
 
 namespace OpenXcom
 {
@@ -29,7 +30,7 @@ enum NodeRank{NR_SCOUT=0, NR_XCOM, NR_SOLDIER, NR_NAVIGATOR, NR_LEADER, NR_ENGIN
  * Represents a node/spawnpoint in the battlescape, loaded from RMP files.
  * @sa http://www.ufopaedia.org/index.php?title=ROUTES
  */
-class Node
+class Node : public PooledObject<Node>
 {
 private:
 	int _id;
@@ -128,7 +128,7 @@ productionProgress_e Production::step(Base * b, SavedGame * g, const Mod *m)
 				if (_rules->getCategory() == "STR_CRAFT")
 				{
 					Craft *craft = new Craft(m->getCraft(i->first, true), b, g->getId(i->first));
-					craft->setStatus("STR_REFUELLING");
+					craft->setStatus(Craft::STATUS_REFUELLING);
 					b->getCrafts()->push_back(craft);
 					break;
 				}
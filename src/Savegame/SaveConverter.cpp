@@ -63,7 +63,6 @@ namespace OpenXcom
 
 enum TargetType { TARGET_NONE, TARGET_UFO, TARGET_CRAFT, TARGET_XBASE, TARGET_ABASE, TARGET_CRASH, TARGET_LANDED, TARGET_WAYPOINT, TARGET_TERROR, TARGET_PORT = 0x51, TARGET_ISLAND = 0x52, TARGET_SHIP = 0x53, TARGET_ARTEFACT = 0x54 };
 const char *xcomAltitudes[] = { "STR_GROUND", "STR_VERY_LOW", "STR_LOW_UC", "STR_HIGH_UC", "STR_VERY_HIGH" };
-const char *xcomStatus[] = { "STR_READY", "STR_OUT", "STR_REPAIRS", "STR_REFUELLING", "STR_REARMING" };
 
 // Helper functions
 template <typename T> T load(char* data) { return *(T*)data; }
@@ -887,7 +886,7 @@ void SaveConverter::loadDatCraft()
 				int dest = load<Uint16>(cdata + _rules->getOffset("CRAFT.DAT_DESTINATION"));
 				node["fuel"] = (int)load<Uint16>(cdata + _rules->getOffset("CRAFT.DAT_FUEL"));
 				int base = load<Uint16>(cdata + _rules->getOffset("CRAFT.DAT_BASE"));
-				node["status"] = xcomStatus[load<Uint16>(cdata + _rules->getOffset("CRAFT.DAT_STATUS"))];
+				node["status"] = Craft::getStatusString((Craft::CraftStatus)load<Uint16>(cdata + _rules->getOffset("CRAFT.DAT_STATUS")));
 
 				// vehicles
 				const size_t VEHICLES = 5;
@@ -18,6 +18,7 @@
  */
 #include <assert.h>
 #include <vector>
+#include <new>
 #include "BattleItem.h"
 #include "SavedBattleGame.h"
 #include "SavedGame.h"
@@ -38,6 +39,8 @@
 #include "../Engine/RNG.h"
 #include "../Engine/Options.h"
 #include "../Engine/Logger.h"
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/MemoryPool.h"
 #include "SerializationHelper.h"
 #include "../Mod/RuleItem.h"
 
@@ -47,7 +50,7 @@ namespace OpenXcom
 /**
  * Initializes a brand new battlescape saved game.
  */
-SavedBattleGame::SavedBattleGame() : _battleState(0), _mapsize_x(0), _mapsize_y(0), _mapsize_z(0), _selectedUnit(0), _lastSelectedUnit(0), _pathfinding(0), _tileEngine(0), _globalShade(0),
+SavedBattleGame::SavedBattleGame() : _battleState(0), _mapsize_x(0), _mapsize_y(0), _mapsize_z(0), _tileStorage(0), _selectedUnit(0), _lastSelectedUnit(0), _pathfinding(0), _tileEngine(0), _globalShade(0),
 	_side(FACTION_PLAYER), _turn(1), _debugMode(false), _aborted(false), _itemId(0), _objectiveType(-1), _objectivesDestroyed(0), _objectivesNeeded(0), _unitsFalling(false), _cheating(false),
 	_tuReserved(BA_NONE), _kneelReserved(false), _depth(0), _ambience(-1), _ambientVolume(0.5), _turnLimit(0), _cheatTurn(20), _chronoTrigger(FORCE_LOSE), _beforeGame(true)
 {
@@ -64,14 +67,9 @@ SavedBattleGame::SavedBattleGame() : _battleState(0), _mapsize_x(0), _mapsize_y(
  */
 SavedBattleGame::~SavedBattleGame()
 {
-	if (_mapsize_z * _mapsize_y * _mapsize_x > 0)
-	{
-		for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
-		{
-			delete _tiles[i];
-		}
-		delete[] _tiles;
-	}
+	Uint32 teardownStart = SDL_GetTicks();
+	bool hadMap = _mapsize_z * _mapsize_y * _mapsize_x > 0;
+	deleteTiles();
 
 	for (std::vector<MapDataSet*>::iterator i = _mapDataSets.begin(); i != _mapDataSets.end(); ++i)
 	{
@@ -107,6 +105,12 @@ SavedBattleGame::~SavedBattleGame()
 
 	delete _pathfinding;
 	delete _tileEngine;
+
+	MemoryPool::releaseAll();
+	if (hadMap)
+	{
+		Log(LOG_INFO) << "Battle cleaned up in " << (SDL_GetTicks() - teardownStart) << " ms, peak memory use " << CrossPlatform::getPeakMemoryUsage() << " KB";
+	}
 }
 
 /**
@@ -493,14 +497,7 @@ Tile **SavedBattleGame::getTiles() const
 void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z, bool resetTerrain)
 {
 	// Clear old map data
-	if (_mapsize_z * _mapsize_y * _mapsize_x > 0)
-	{
-		for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
-		{
-			delete _tiles[i];
-		}
-		delete[] _tiles;
-	}
+	deleteTiles();
 
 	for (std::vector<Node*>::iterator i = _nodes.begin(); i != _nodes.end(); ++i)
 	{
@@ -518,15 +515,34 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z, bool
 	_mapsize_y = mapsize_y;
 	_mapsize_z = mapsize_z;
 	_tiles = new Tile*[_mapsize_z * _mapsize_y * _mapsize_x];
+	// all the tiles go in one block, in index order, so passes over the whole map walk straight through memory
+	_tileStorage = static_cast<Tile*>(::operator new(sizeof(Tile) * _mapsize_z * _mapsize_y * _mapsize_x));
 	for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
 	{
 		Position pos;
 		getTileCoords(i, &pos.x, &pos.y, &pos.z);
-		_tiles[i] = new Tile(pos);
+		_tiles[i] = new (_tileStorage + i) Tile(pos);
 	}
 
 }
 
+/**
+ * Destroys the tiles and frees the block they live in.
+ */
+void SavedBattleGame::deleteTiles()
+{
+	if (_mapsize_z * _mapsize_y * _mapsize_x > 0)
+	{
+		for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
+		{
+			_tiles[i]->~Tile();
+		}
+		::operator delete(_tileStorage);
+		_tileStorage = 0;
+		delete[] _tiles;
+	}
+}
+
 /**
  * Initializes the map utilities.
  * @param mod Pointer to mod.
@@ -1176,6 +1192,7 @@ Node *SavedBattleGame::getSpawnNode(int nodeRank, BattleUnit *unit)
 			continue;
 		}
 		if ((*i)->getRank() == nodeRank								// ranks must match
+			&& (*i)->getPriority() >= highestPriority				// lower priority nodes would be dropped anyway
 			&& (!((*i)->getType() & Node::TYPE_SMALL)
 				|| unit->getArmor()->getSize() == 1)				// the small unit bit is not set or the unit is small
 			&& (!((*i)->getType() & Node::TYPE_FLYING)
@@ -1211,7 +1228,7 @@ Node *SavedBattleGame::getSpawnNode(int nodeRank, BattleUnit *unit)
  */
 Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNode)
 {
-	std::vector<Node *> compliantNodes;
+	std::vector<Node *> compliantNodes, unlinkedNodes;
 	Node *preferred = 0;
 
 	if (fromNode == 0)
@@ -1244,6 +1261,11 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 			&& (!scout || n != fromNode)																// scouts push forward
 			&& n->getPosition().x > 0 && n->getPosition().y > 0)
 		{
+			if (scout && !isNodeReachable(fromNode, n))
+			{
+				unlinkedNodes.push_back(n); // no route there, only pick it if there's nothing else
+				continue;
+			}
 			if (!preferred
 				|| (unit->getRankInt() >=0 &&
 					preferred->getRank() == Node::nodeRank[unit->getRankInt()][0] &&
@@ -1256,6 +1278,10 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 		}
 	}
 
+	if (compliantNodes.empty())
+	{
+		compliantNodes = unlinkedNodes;
+	}
 	if (compliantNodes.empty())
 	{
 		if (Options::traceAI) { Log(LOG_INFO) << (scout ? "Scout " : "Guard") << " found on patrol node! XXX XXX XXX"; }
@@ -1282,6 +1308,56 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 	}
 }
 
+/**
+ * Checks if the route graph connects one node to another. The nodes
+ * reachable from each starting node are worked out the first time
+ * they're asked for and kept until an object part of a tile changes,
+ * as that's what can block the links (doors are walls, so opening
+ * them leaves the graph alone).
+ * @param from Pointer to the starting node.
+ * @param to Pointer to the destination node.
+ * @return True if the node links lead from one to the other.
+ */
+bool SavedBattleGame::isNodeReachable(Node *from, Node *to)
+{
+	const int n = _nodes.size();
+	if (from->getID() < 0 || from->getID() >= n || to->getID() < 0 || to->getID() >= n)
+	{
+		return false;
+	}
+	if (_nodeReach.size() != (size_t)n)
+	{
+		_nodeReach.assign(n, std::vector<bool>());
+		_nodeReachRevision.assign(n, 0);
+	}
+	std::vector<bool> &reach = _nodeReach[from->getID()];
+	if (reach.empty() || _nodeReachRevision[from->getID()] != Tile::getObjectRevision())
+	{
+		reach.assign(n, false);
+		_nodeReachRevision[from->getID()] = Tile::getObjectRevision();
+		std::vector<int> open;
+		reach[from->getID()] = true;
+		open.push_back(from->getID());
+		while (!open.empty())
+		{
+			Node *node = _nodes[open.back()];
+			open.pop_back();
+			for (std::vector<int>::const_iterator i = node->getNodeLinks()->begin(); i != node->getNodeLinks()->end(); ++i)
+			{
+				if (*i < 0 || *i >= n || reach[*i] || _nodes[*i]->isDummy())
+					continue;
+				Tile *tile = getTile(_nodes[*i]->getPosition());
+				// links into collapsed or blocked terrain don't count
+				if (!tile || tile->getTUCost(O_OBJECT, MT_WALK) == 255)
+					continue;
+				reach[*i] = true;
+				open.push_back(*i);
+			}
+		}
+	}
+	return reach[to->getID()];
+}
+
 /**
  * Carries out new turn preparations such as fire and smoke spreading.
  */
@@ -51,8 +51,11 @@ private:
 	int _mapsize_x, _mapsize_y, _mapsize_z;
 	std::vector<MapDataSet*> _mapDataSets;
 	Tile **_tiles;
+	Tile *_tileStorage;
 	BattleUnit *_selectedUnit, *_lastSelectedUnit;
 	std::vector<Node*> _nodes;
+	std::vector<std::vector<bool> > _nodeReach;
+	std::vector<unsigned int> _nodeReachRevision;
 	std::vector<BattleUnit*> _units;
 	std::vector<BattleItem*> _items, _deleted;
 	Pathfinding *_pathfinding;
@@ -81,6 +84,8 @@ private:
 	bool _beforeGame;
 	/// Selects a soldier.
 	BattleUnit *selectPlayerUnit(int dir, bool checkReselect = false, bool setReselect = false, bool checkInventory = false);
+	/// Destroys the map's tiles.
+	void deleteTiles();
 public:
 	/// Creates a new battle save, based on the current generic save.
 	SavedBattleGame();
@@ -197,6 +202,8 @@ public:
 	Node *getSpawnNode(int nodeRank, BattleUnit *unit);
 	/// Gets a patrol node.
 	Node *getPatrolNode(bool scout, BattleUnit *unit, Node *fromNode);
+	/// Checks if the route graph connects two nodes.
+	bool isNodeReachable(Node *from, Node *to);
 	/// Carries out new turn preparations.
 	void prepareNewTurn();
 	/// Revives unconscious units (healthcheck).
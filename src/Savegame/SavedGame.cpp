@@ -98,7 +98,7 @@ bool equalProduction::operator()(const Production * p) const
 /**
  * Initializes a brand new saved game according to the specified difficulty.
  */
-SavedGame::SavedGame() : _difficulty(DIFF_BEGINNER), _end(END_NONE), _ironman(false), _globeLon(0.0), _globeLat(0.0), _globeZoom(0), _battleGame(0), _debug(false), _warned(false), _monthsPassed(-1), _selectedBase(0)
+SavedGame::SavedGame() : _difficulty(DIFF_BEGINNER), _end(END_NONE), _ironman(false), _globeLon(0.0), _globeLat(0.0), _globeZoom(0), _battleGame(0), _researchGraph(0), _debug(false), _warned(false), _monthsPassed(-1), _selectedBase(0)
 {
 	_time = new GameTime(6, 1, 1, 1999, 12, 0, 0);
 	_alienStrategy = new AlienStrategy();
@@ -490,6 +490,8 @@ void SavedGame::load(const std::string &filename, Mod *mod)
 			Log(LOG_ERROR) << "Failed to load research " << research;
 		}
 	}
+	_researchGraph = 0;
+	updateResearchProgress(mod);
 
 	for (YAML::const_iterator i = doc["bases"].begin(); i != doc["bases"].end(); ++i)
 	{
@@ -1079,6 +1081,30 @@ void SavedGame::setBattleGame(SavedBattleGame *battleGame)
 void SavedGame::addFinishedResearchSimple(const RuleResearch * research)
 {
 	_discovered.push_back(research);
+	if (_researchGraph != 0)
+	{
+		_researchGraph->discover(&_researchProgress, research->getIndex());
+	}
+}
+
+/**
+ * Rebuilds the research progress from the list of discovered
+ * topics whenever it isn't tracking the graph of the given mod yet,
+ * so all the research checks can be answered with simple lookups.
+ * @param mod the game Mod
+ */
+void SavedGame::updateResearchProgress(const Mod * mod) const
+{
+	if (_researchGraph == mod->getResearchGraph())
+	{
+		return;
+	}
+	_researchGraph = mod->getResearchGraph();
+	_researchGraph->reset(&_researchProgress);
+	for (std::vector<const RuleResearch *>::const_iterator i = _discovered.begin(); i != _discovered.end(); ++i)
+	{
+		_researchGraph->discover(&_researchProgress, (*i)->getIndex());
+	}
 }
 
 /**
@@ -1090,9 +1116,13 @@ void SavedGame::addFinishedResearchSimple(const RuleResearch * research)
  */
 void SavedGame::addFinishedResearch(const RuleResearch * research, const Mod * mod, Base * base, bool score)
 {
+	updateResearchProgress(mod);
+
 	// Not really a queue in C++ terminology (we don't need or want pop_front())
 	std::vector<const RuleResearch *> queue;
+	std::vector<char> queued(mod->getResearchList().size(), 0);
 	queue.push_back(research);
+	queued[research->getIndex()] = 1;
 
 	size_t currentQueueIndex = 0;
 	while (queue.size() > currentQueueIndex)
@@ -1104,10 +1134,10 @@ void SavedGame::addFinishedResearch(const RuleResearch * research, const Mod * m
 
 		// 2. If the currentQueueItem was *not* already discovered before, add it to discovered research
 		bool checkRelatedZeroCostTopics = true;
-		if (!isResearched(currentQueueItem->getName(), false))
+		if (!_researchProgress.researched[currentQueueItem->getIndex()])
 		{
-			_discovered.push_back(currentQueueItem);
-			if (!hasUndiscoveredProtectedUnlocks && isResearched(currentQueueItem->getGetOneFree(), false))
+			addFinishedResearchSimple(currentQueueItem);
+			if (!hasUndiscoveredProtectedUnlocks && _researchProgress.undiscoveredFree[currentQueueItem->getIndex()] == 0)
 			{
 				// If the currentQueueItem can't tell you anything anymore, remove it from popped research
 				// Note: this is for optimisation purposes only, functionally it is *not* required...
@@ -1156,22 +1186,13 @@ void SavedGame::addFinishedResearch(const RuleResearch * research, const Mod * m
 				if ((*itProjectToTest)->getCost() == 0)
 				{
 					// We are only interested in *new* projects (i.e. not processed or scheduled for processing yet)
-					bool isAlreadyInTheQueue = false;
-					for (std::vector<const RuleResearch *>::const_iterator itQueue = queue.begin(); itQueue != queue.end(); ++itQueue)
-					{
-						if ((*itQueue)->getName() == (*itProjectToTest)->getName())
-						{
-							isAlreadyInTheQueue = true;
-							break;
-						}
-					}
-
-					if (!isAlreadyInTheQueue)
+					if (!queued[(*itProjectToTest)->getIndex()])
 					{
 						if ((*itProjectToTest)->getRequirements().empty())
 						{
 							// no additional checks for "unprotected" topics
 							queue.push_back((*itProjectToTest));
+							queued[(*itProjectToTest)->getIndex()] = 1;
 						}
 						else
 						{
@@ -1181,6 +1202,7 @@ void SavedGame::addFinishedResearch(const RuleResearch * research, const Mod * m
 								if ((*itProjectToTest)->getName() == (*itUnlocks))
 								{
 									queue.push_back((*itProjectToTest));
+									queued[(*itProjectToTest)->getIndex()] = 1;
 									break;
 								}
 							}
@@ -1213,30 +1235,25 @@ const std::vector<const RuleResearch *> & SavedGame::getDiscoveredResearch() con
  */
 void SavedGame::getAvailableResearchProjects(std::vector<RuleResearch *> & projects, const Mod * mod, Base * base, bool considerDebugMode) const
 {
-	// This list is used for topics that can be researched even if *not all* dependencies have been discovered yet (e.g. STR_ALIEN_ORIGINS)
-	// Note: all requirements of such topics *have to* be discovered though! This will be handled elsewhere.
-	std::vector<const RuleResearch *> unlocked;
-	for (std::vector<const RuleResearch *>::const_iterator it = _discovered.begin(); it != _discovered.end(); ++it)
-	{
-		for (std::vector<std::string>::const_iterator itUnlocked = (*it)->getUnlocked().begin(); itUnlocked != (*it)->getUnlocked().end(); ++itUnlocked)
-		{
-			unlocked.push_back(mod->getResearch(*itUnlocked, true));
-		}
-	}
+	updateResearchProgress(mod);
+	bool debug = considerDebugMode && _debug;
 
 	// Create a list of research topics available for research in the given base
-	for (std::vector<std::string>::const_iterator iter = mod->getResearchList().begin(); iter != mod->getResearchList().end(); ++iter)
+	size_t count = mod->getResearchList().size();
+	for (size_t i = 0; i != count; ++i)
 	{
-		RuleResearch *research = mod->getResearch(*iter);
+		RuleResearch *research = mod->getResearchByIndex(i);
 
-		if ((considerDebugMode && _debug) || std::find(unlocked.begin(), unlocked.end(), research) != unlocked.end())
+		// Topics unlocked by a discovered topic can be researched even if *not all* dependencies have been discovered yet (e.g. STR_ALIEN_ORIGINS)
+		// Note: all requirements of such topics *have to* be discovered though! This will be handled elsewhere.
+		if (debug || _researchProgress.unlockers[i] != 0)
 		{
 			// Empty, these research topics are on the "unlocked list", *don't* check the dependencies!
 		}
 		else
 		{
 			// These items are not on the "unlocked list", we must check if "dependencies" are satisfied!
-			if (!isResearched(research->getDependencies(), considerDebugMode))
+			if (_researchProgress.unmetDependencies[i] != 0)
 			{
 				continue;
 			}
@@ -1248,19 +1265,19 @@ void SavedGame::getAvailableResearchProjects(std::vector<RuleResearch *> & proje
 		//   - there is an additional filter in NewPossibleResearchState::NewPossibleResearchState()
 		//   - we do this check for other functionality using this method, namely SavedGame::addFinishedResearch()
 		//     - Note: when called from there, parameter considerDebugMode = false
-		if (!isResearched(research->getRequirements(), considerDebugMode))
+		if (!debug && _researchProgress.unmetRequirements[i] != 0)
 		{
 			continue;
 		}
 
 		// Remove the already researched topics from the list *UNLESS* they can still give you something more
-		if (isResearched(research->getName(), false))
+		if (_researchProgress.researched[i])
 		{
-			if (!isResearched(research->getGetOneFree(), false))
+			if (_researchProgress.undiscoveredFree[i] != 0)
 			{
 				// This research topic still has some more undiscovered "getOneFree" topics, keep it!
 			}
-			else if (hasUndiscoveredProtectedUnlock(research, mod))
+			else if (_researchProgress.undiscoveredProtectedUnlocks[i] != 0)
 			{
 				// This research topic still has one or more undiscovered "protected unlocks", keep it!
 			}
@@ -1331,15 +1348,14 @@ void SavedGame::getNewlyAvailableResearchProjects(std::vector<RuleResearch *> &
  */
 void SavedGame::getAvailableProductions (std::vector<RuleManufacture *> & productions, const Mod * mod, Base * base) const
 {
-	const std::vector<std::string> &items = mod->getManufactureList();
+	updateResearchProgress(mod);
 	const std::vector<Production *>& baseProductions (base->getProductions());
 
-	for (std::vector<std::string>::const_iterator iter = items.begin();
-		iter != items.end();
-		++iter)
+	size_t count = mod->getManufactureList().size();
+	for (size_t i = 0; i != count; ++i)
 	{
-		RuleManufacture *m = mod->getManufacture(*iter);
-		if (!isResearched(m->getRequirements()))
+		RuleManufacture *m = mod->getManufactureByIndex(i);
+		if (!_debug && _researchProgress.unmetManufacture[i] != 0)
 		{
 			continue;
 		}
@@ -1360,14 +1376,13 @@ void SavedGame::getAvailableProductions (std::vector<RuleManufacture *> & produc
  */
 void SavedGame::getDependableManufacture (std::vector<RuleManufacture *> & dependables, const RuleResearch *research, const Mod * mod, Base *) const
 {
-	const std::vector<std::string> &mans = mod->getManufactureList();
-	for (std::vector<std::string>::const_iterator iter = mans.begin(); iter != mans.end(); ++iter)
+	updateResearchProgress(mod);
+	const std::vector<int> &mans = _researchGraph->getManufactureRequiredBy(research->getIndex());
+	for (std::vector<int>::const_iterator iter = mans.begin(); iter != mans.end(); ++iter)
 	{
-		RuleManufacture *m = mod->getManufacture(*iter);
-		const std::vector<std::string> &reqs = m->getRequirements();
-		if (isResearched(m->getRequirements()) && std::find(reqs.begin(), reqs.end(), research->getName()) != reqs.end())
+		if (_debug || _researchProgress.unmetManufacture[*iter] == 0)
 		{
-			dependables.push_back(m);
+			dependables.push_back(mod->getManufactureByIndex(*iter));
 		}
 	}
 }
@@ -1381,18 +1396,8 @@ void SavedGame::getDependableManufacture (std::vector<RuleManufacture *> & depen
 bool SavedGame::hasUndiscoveredProtectedUnlock(const RuleResearch * r, const Mod * mod) const
 {
 	// Note: checking for not yet discovered unlocks protected by "requires" (which also implies cost = 0)
-	for (std::vector<std::string>::const_iterator itUnlocked = r->getUnlocked().begin(); itUnlocked != r->getUnlocked().end(); ++itUnlocked)
-	{
-		RuleResearch *unlock = mod->getResearch(*itUnlocked, true);
-		if (!unlock->getRequirements().empty())
-		{
-			if (!isResearched(unlock->getName(), false))
-			{
-				return true;
-			}
-		}
-	}
-	return false;
+	updateResearchProgress(mod);
+	return _researchProgress.undiscoveredProtectedUnlocks[r->getIndex()] != 0;
 }
 
 /**
@@ -1407,6 +1412,11 @@ bool SavedGame::isResearched(const std::string &research, bool considerDebugMode
 	//	return true;
 	if (considerDebugMode && _debug)
 		return true;
+	if (_researchGraph != 0)
+	{
+		int index = _researchGraph->getIndex(research);
+		return index != -1 && _researchProgress.researched[index];
+	}
 	for (std::vector<const RuleResearch *>::const_iterator i = _discovered.begin(); i != _discovered.end(); ++i)
 	{
 		if ((*i)->getName() == research)
@@ -1428,6 +1438,16 @@ bool SavedGame::isResearched(const std::vector<std::string> &research, bool cons
 		return true;
 	if (considerDebugMode && _debug)
 		return true;
+	if (_researchGraph != 0)
+	{
+		for (std::vector<std::string>::const_iterator i = research.begin(); i != research.end(); ++i)
+		{
+			int index = _researchGraph->getIndex(*i);
+			if (index == -1 || !_researchProgress.researched[index])
+				return false;
+		}
+		return true;
+	}
 	std::vector<std::string> matches = research;
 	for (std::vector<const RuleResearch *>::const_iterator i = _discovered.begin(); i != _discovered.end(); ++i)
 	{
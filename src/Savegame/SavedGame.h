@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include "GameTime.h"
 #include "../Mod/RuleAlienMission.h"
+#include "../Mod/ResearchGraph.h"
 #include "../Savegame/Craft.h"
 
 namespace OpenXcom
@@ -119,6 +120,8 @@ private:
 	AlienStrategy *_alienStrategy;
 	SavedBattleGame *_battleGame;
 	std::vector<const RuleResearch*> _discovered;
+	mutable const ResearchGraph *_researchGraph;
+	mutable ResearchProgress _researchProgress;
 	std::vector<AlienMission*> _activeMissions;
 	bool _debug, _warned;
 	int _monthsPassed;
@@ -132,6 +135,8 @@ private:
 	std::vector<MissionStatistics*> _missionStatistics;
 
 	static SaveInfo getSaveInfo(const std::string &file, Language *lang);
+	/// Brings the research progress in line with the mod.
+	void updateResearchProgress(const Mod *mod) const;
 public:
 	static const std::string AUTOSAVE_GEOSCAPE, AUTOSAVE_BATTLESCAPE, QUICKSAVE;
 	/// Creates a new saved game.
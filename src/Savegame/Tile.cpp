@@ -44,6 +44,13 @@ Tile::SerializationKey Tile::serializationKey =
  4 + 2*4 + 2*4 + 1 + 1 + 1 // total bytes to save one tile
 };
 
+/// Bumped whenever anything the pathfinding reads from a tile changes.
+unsigned int Tile::_revision = 0;
+/// Bumped whenever a tile's object part changes.
+unsigned int Tile::_objectRevision = 0;
+/// The tiles behind the last revisions, (-1, -1, -1) for changes to no tile in particular.
+Position Tile::_changeLog[Tile::CHANGE_LOG_SIZE];
+
 /**
  * constructor
  * @param pos Position.
@@ -219,6 +226,37 @@ void Tile::setMapData(MapData *dat, int mapDataID, int mapDataSetID, int part)
 	_objects[part] = dat;
 	_mapDataID[part] = mapDataID;
 	_mapDataSetID[part] = mapDataSetID;
+	touch();
+	if (part == O_OBJECT)
+	{
+		++_objectRevision;
+	}
+}
+
+/**
+ * Gets the tiles that changed since a revision, so caches can forget
+ * only what depends on them. Only the last few changes are kept.
+ * @param revision Revision the caller is up to date with.
+ * @param changes Vector to add the positions of the changed tiles to.
+ * @return False if the changes are too many or not tied to tiles,
+ * in which case everything has to be taken as changed.
+ */
+bool Tile::getChangesSince(unsigned int revision, std::vector<Position> *changes)
+{
+	if (_revision - revision > CHANGE_LOG_SIZE)
+	{
+		return false;
+	}
+	for (unsigned int i = revision; i != _revision; ++i)
+	{
+		const Position &pos = _changeLog[i % CHANGE_LOG_SIZE];
+		if (pos.x < 0)
+		{
+			return false;
+		}
+		changes->push_back(pos);
+	}
+	return true;
 }
 
 /**
@@ -354,6 +392,7 @@ int Tile::openDoor(int part, BattleUnit *unit, BattleActionType reserve)
 		if (unit &&	unit->getTimeUnits() < _objects[part]->getTUCost(unit->getMovementType()) + unit->getActionTUs(reserve, unit->getMainHandWeapon(false)))
 			return 4;
 		_currentFrame[part] = 1; // start opening door
+		touch();
 		return 1;
 	}
 	if (_objects[part]->isUFODoor() && _currentFrame[part] != 7) // ufo door != part 7 - door is still opening
@@ -372,6 +411,7 @@ int Tile::closeUfoDoor()
 		if (isUfoDoorOpen(part))
 		{
 			_currentFrame[part] = 0;
+			touch();
 			retval = 1;
 		}
 	}
@@ -610,6 +650,7 @@ void Tile::ignite(int power)
 				_overlaps = 1;
 				_fire = getFuel() + 1;
 				_animationOffset = RNG::generate(0,3);
+				touch();
 			}
 		}
 	}
@@ -640,6 +681,10 @@ void Tile::animate()
 			{
 				newframe = 0;
 			}
+			if (_objects[i]->isUFODoor())
+			{
+				touch();
+			}
 			_currentFrame[i] = newframe;
 		}
 	}
@@ -682,6 +727,7 @@ void Tile::setUnit(BattleUnit *unit, Tile *tileBelow)
 		unit->setTile(this, tileBelow);
 	}
 	_unit = unit;
+	touch();
 }
 
 /**
@@ -692,6 +738,7 @@ void Tile::setFire(int fire)
 {
 	_fire = fire;
 	_animationOffset = RNG::generate(0,3);
+	touch();
 }
 
 /**
@@ -58,6 +58,9 @@ public:
 
 protected:
 	static const int LIGHTLAYERS = 3;
+	static const unsigned int CHANGE_LOG_SIZE = 64;
+	static unsigned int _revision, _objectRevision;
+	static Position _changeLog[CHANGE_LOG_SIZE];
 	MapData *_objects[4];
 	int _mapDataID[4];
 	int _mapDataSetID[4];
@@ -79,11 +82,21 @@ protected:
 	int _overlaps;
 	bool _danger;
 	std::list<Particle*> _particles;
+	/// Bumps the revision, remembering this tile as the one that changed.
+	void touch() { _changeLog[_revision % CHANGE_LOG_SIZE] = _pos; ++_revision; }
+	/// Bumps the revision for a change not tied to one tile.
+	static void touchAll() { _changeLog[_revision % CHANGE_LOG_SIZE] = Position(-1, -1, -1); ++_revision; }
 public:
 	/// Creates a tile.
 	Tile(Position pos);
 	/// Cleans up a tile.
 	~Tile();
+	/// Gets the revision of the walkable state of all tiles.
+	static unsigned int getRevision() { return _revision; }
+	/// Gets the revision of the object parts of all tiles.
+	static unsigned int getObjectRevision() { return _objectRevision; }
+	/// Gets the tiles changed since a revision.
+	static bool getChangesSince(unsigned int revision, std::vector<Position> *changes);
 	/// Load the tile from yaml
 	void load(const YAML::Node &node);
 	/// Load the tile from binary buffer in memory
@@ -105,6 +118,12 @@ public:
 
 	/// Sets the pointer to the mapdata for a specific part of the tile
 	void setMapData(MapData *dat, int mapDataID, int mapDataSetID, int part);
+	/// Sets the mapdata for a part without touching the revisions, so map blocks can be filled in from several threads.
+	void setMapDataUntracked(MapData *dat, int mapDataID, int mapDataSetID, int part) { _objects[part] = dat; _mapDataID[part] = mapDataID; _mapDataSetID[part] = mapDataSetID; }
+	/// Marks the walkable state as changed, when an occupant changes in a way setUnit() doesn't see.
+	static void touchOccupants() { touchAll(); }
+	/// Marks the terrain as changed, after setMapDataUntracked().
+	static void touchTerrain() { touchAll(); ++_objectRevision; }
 	/// Gets the IDs to the mapdata for a specific part of the tile
 	void getMapData(int *mapDataID, int *mapDataSetID, int part) const;
 	/// Gets whether this tile has no objects